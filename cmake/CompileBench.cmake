@@ -0,0 +1,90 @@
+# Measures the compile-time cost of the dimension metaprogramming.
+# For every size in SIZES a translation unit with that many distinct dimensions is generated; it multiplies
+# them in one order, compares with the product in the reverse order (the same canonical type, sorted by merges)
+# and divides them back out one by one (cancellation); the product type is also used in an explicitly instantiated template,
+# so its mangled name lands in the object file. Each TU is compiled once and the wall time, the object size and
+# the template instantiation cost (number of instantiations from Clang's -ftime-trace, instantiation wall time
+# from GCC's -ftime-report) are written to OUTPUT_DIR/compile_bench.json.
+#
+# Usage: cmake -DCXX=<compiler> -DCXX_ID=<GNU|Clang|...> -DINCLUDE_DIR=<src> -DOUTPUT_DIR=<dir> [-DSIZES=2;4;8] -P CompileBench.cmake
+
+cmake_minimum_required(VERSION 3.23)
+
+if (NOT SIZES)
+    set(SIZES 2 4 8 16 32 48 64)
+endif()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+function(generate_tu size path)
+    math(EXPR last "${size} - 1")
+    set(source "#include \"safe_types.h\"\n\n")
+    foreach(i RANGE ${last})
+        string(APPEND source "class Dim${i};\nusing Q${i} = safe_types::simple_type<long long, std::ratio<1>, Dim${i}>;\n")
+    endforeach()
+
+    set(forward "Q0{ 1 }")
+    set(backward "Q${last}{ 1 }")
+    set(divided "product()")
+    foreach(i RANGE 1 ${last})
+        math(EXPR j "${last} - ${i}")
+        string(APPEND forward " * Q${i}{ 1 }")
+        string(APPEND backward " * Q${j}{ 1 }")
+    endforeach()
+    foreach(i RANGE ${last})
+        string(APPEND divided " / Q${i}{ 1 }")
+    endforeach()
+
+    string(APPEND source "\nauto product() { return ${forward}; }\n")
+    string(APPEND source "auto reversed() { return ${backward}; }\n")
+    string(APPEND source "bool same() { return product() == reversed(); }\n")
+    string(APPEND source "auto divided() { return ${divided}; }\n")
+    string(APPEND source "template<typename T> T identity(T value) { return value; }\n")
+    string(APPEND source "template decltype(product()) identity(decltype(product()));\n")
+    file(WRITE "${path}" "${source}")
+endfunction()
+
+set(flags -std=c++17 -O2 -c "-I${INCLUDE_DIR}")
+if (CXX_ID MATCHES "Clang")
+    list(APPEND flags -ftime-trace)
+elseif (CXX_ID STREQUAL "GNU")
+    list(APPEND flags -ftime-report)
+endif()
+
+set(entries "")
+foreach(size IN LISTS SIZES)
+    set(source "${OUTPUT_DIR}/dims_${size}.cpp")
+    set(object "${OUTPUT_DIR}/dims_${size}.o")
+    generate_tu(${size} "${source}")
+
+    string(TIMESTAMP start "%s%f")
+    execute_process(COMMAND "${CXX}" ${flags} "${source}" -o "${object}" RESULT_VARIABLE result ERROR_VARIABLE errors)
+    string(TIMESTAMP stop "%s%f")
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "compiling ${source} failed:\n${errors}")
+    endif()
+    math(EXPR microseconds "${stop} - ${start}")
+    file(SIZE "${object}" object_bytes)
+
+    # -1 marks a figure the compiler does not report
+    set(instantiations -1)
+    set(instantiation_seconds -1)
+    if (EXISTS "${OUTPUT_DIR}/dims_${size}.json")
+        file(READ "${OUTPUT_DIR}/dims_${size}.json" trace)
+        string(REGEX MATCHALL "\"name\":\"Instantiate(Class|Function)\"" events "${trace}")
+        list(LENGTH events instantiations)
+    endif()
+    if (errors MATCHES "template instantiation *: *[0-9.]+ *\\([ 0-9]+%\\) *[0-9.]+ *\\([ 0-9]+%\\) *([0-9.]+)")
+        set(instantiation_seconds ${CMAKE_MATCH_1})
+    endif()
+
+    message(STATUS "dimensions ${size}: ${microseconds} us, ${object_bytes} bytes, "
+        "${instantiations} instantiations, ${instantiation_seconds} s instantiating")
+    set(entry "    { \"dimensions\": ${size}, \"compile_us\": ${microseconds}, \"object_bytes\": ${object_bytes}, ")
+    string(APPEND entry "\"instantiations\": ${instantiations}, \"instantiation_s\": ${instantiation_seconds} }")
+    list(APPEND entries "${entry}")
+endforeach()
+
+list(JOIN entries ",\n" body)
+file(WRITE "${OUTPUT_DIR}/compile_bench.json" "{\n  \"compiler\": \"${CXX_ID}\",\n  \"benchmarks\": [\n${body}\n  ]\n}\n")
+message(STATUS "results written to ${OUTPUT_DIR}/compile_bench.json")
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    class arena_view;
+
+    namespace internal
+    {
+        // epochs of the live string_arenas: an arena takes a slot of a fixed table when it is made and
+        // stores a new epoch in it on each reset(), and a view is valid while the slot still holds the
+        // epoch the view was made in. The slot is in the low bits of the epoch, so starting and ending
+        // one neither locks nor allocates and a check is one atomic load. Arenas made while every slot
+        // is taken get epoch 0, which is never checked, as are all epochs of release builds
+        class arena_epochs
+        {
+        public:
+            static arena_epochs& instance() noexcept
+            {
+                static arena_epochs epochs;
+                return epochs;
+            }
+
+            uint64_t start() noexcept
+            {
+                const uint64_t generation = next_generation();
+                for (uint64_t i = 0; i < slot_count; ++i) {
+                    const uint64_t slot = (generation + i) & slot_mask;
+                    uint64_t free = 0;
+                    if (m_slots[slot].compare_exchange_strong(free, (generation << slot_bits) | slot, std::memory_order_acq_rel)) {
+                        return (generation << slot_bits) | slot;
+                    }
+                }
+                return 0;
+            }
+
+            // a new epoch in the slot of epoch, which the arena keeps
+            uint64_t restart(uint64_t epoch) noexcept
+            {
+                if (epoch == 0) {
+                    return 0;
+                }
+                const uint64_t next = (next_generation() << slot_bits) | (epoch & slot_mask);
+                m_slots[epoch & slot_mask].store(next, std::memory_order_release);
+                return next;
+            }
+
+            void end(uint64_t epoch) noexcept
+            {
+                if (epoch != 0) {
+                    m_slots[epoch & slot_mask].store(0, std::memory_order_release);
+                }
+            }
+
+            bool live(uint64_t epoch) const noexcept
+            {
+                return m_slots[epoch & slot_mask].load(std::memory_order_acquire) == epoch;
+            }
+
+        private:
+            static constexpr unsigned slot_bits = 12;
+            static constexpr uint64_t slot_count = uint64_t{ 1 } << slot_bits;
+            static constexpr uint64_t slot_mask = slot_count - 1;
+
+            arena_epochs() = default;
+
+            // generations start at 1, so that no live epoch is 0
+            uint64_t next_generation() noexcept
+            {
+                return m_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+
+            std::atomic<uint64_t> m_generation{ 0 };
+            std::atomic<uint64_t> m_slots[slot_count] = {};
+        };
+    }
+
+    // bump allocator for the bytes of parsed input: a request is read into allocate()-d memory
+    // (or copied in with store()) and its fields are strong-typed as arena_view singletons without
+    // further allocation. Every view dies with the arena or its next reset(); debug builds
+    // check this on each access. Both classes have the same layout in debug and release builds.
+    class string_arena
+    {
+    public:
+        explicit string_arena(size_t block_size = 4096)
+            : m_block_size{ block_size }
+        {
+#if !defined(NDEBUG)
+            m_epoch = internal::arena_epochs::instance().start();
+#endif
+        }
+
+        string_arena(const string_arena&) = delete;
+        string_arena& operator=(const string_arena&) = delete;
+
+        ~string_arena()
+        {
+#if !defined(NDEBUG)
+            internal::arena_epochs::instance().end(m_epoch);
+#endif
+        }
+
+        // uninitialized bytes that live until the next reset()
+        char* allocate(size_t size)
+        {
+            if (m_blocks.empty() || m_used + size > m_blocks.back().size) {
+                const size_t block_size = size > m_block_size ? size : m_block_size;
+                m_blocks.push_back(block{ std::make_unique<char[]>(block_size), block_size });
+                m_used = 0;
+            }
+            char* bytes = m_blocks.back().bytes.get() + m_used;
+            m_used += size;
+            m_bytes += size;
+            return bytes;
+        }
+
+        // view of text, which must lie in memory of this arena
+        arena_view view(std::string_view text) const;
+
+        // view of a copy of text
+        arena_view store(std::string_view text);
+
+        // releases the memory and invalidates every view
+        void reset() noexcept
+        {
+            m_blocks.clear();
+            m_used = 0;
+            m_bytes = 0;
+#if !defined(NDEBUG)
+            m_epoch = internal::arena_epochs::instance().restart(m_epoch);
+#endif
+        }
+
+        size_t bytes_used() const noexcept
+        {
+            return m_bytes;
+        }
+
+        bool owns(std::string_view text) const noexcept
+        {
+            const auto address = reinterpret_cast<uintptr_t>(text.data());
+            for (const auto& block : m_blocks) {
+                const auto begin = reinterpret_cast<uintptr_t>(block.bytes.get());
+                if (address >= begin && address + text.size() <= begin + block.size) {
+                    return true;
+                }
+            }
+            return text.empty();
+        }
+
+    private:
+        friend class arena_view;
+
+        struct block
+        {
+            std::unique_ptr<char[]> bytes;
+            size_t size;
+        };
+
+        size_t m_block_size;
+        std::vector<block> m_blocks;
+        // bytes taken from the last block
+        size_t m_used = 0;
+        size_t m_bytes = 0;
+        uint64_t m_epoch = 0;
+    };
+
+    // characters owned by a string_arena: a string_view and the epoch of the arena it was made in,
+    // trivially copyable. Debug builds assert on access that the arena is neither destroyed nor
+    // reset since the view was made.
+    class arena_view
+    {
+    public:
+        arena_view() noexcept = default;
+
+        std::string_view view() const noexcept
+        {
+            assert(valid() && "arena_view used after its string_arena was reset or destroyed");
+            return m_text;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        const char* data() const noexcept
+        {
+            return view().data();
+        }
+
+        size_t size() const noexcept
+        {
+            return view().size();
+        }
+
+        bool empty() const noexcept
+        {
+            return view().empty();
+        }
+
+        // false once the arena was reset or destroyed; always true in release builds
+        bool valid() const noexcept
+        {
+#if !defined(NDEBUG)
+            return m_epoch == 0 || internal::arena_epochs::instance().live(m_epoch);
+#else
+            return true;
+#endif
+        }
+
+        friend bool operator==(const arena_view& first, const arena_view& second) noexcept
+        {
+            return first.view() == second.view();
+        }
+
+        friend bool operator!=(const arena_view& first, const arena_view& second) noexcept
+        {
+            return !(first == second);
+        }
+
+        friend bool operator<(const arena_view& first, const arena_view& second) noexcept
+        {
+            return first.view() < second.view();
+        }
+
+        template<typename Stream>
+        friend Stream& operator<<(Stream& stream, const arena_view& value)
+        {
+            return stream << value.view();
+        }
+
+    private:
+        friend class string_arena;
+
+        arena_view(const string_arena& arena, std::string_view text) noexcept
+            : m_text{ text }
+            , m_epoch{ arena.m_epoch }
+        {
+        }
+
+        std::string_view m_text;
+        uint64_t m_epoch = 0;
+    };
+
+    inline arena_view string_arena::view(std::string_view text) const
+    {
+        assert(owns(text) && "arena_view of memory outside the string_arena");
+        return arena_view{ *this, text };
+    }
+
+    inline arena_view string_arena::store(std::string_view text)
+    {
+        char* bytes = allocate(text.size());
+        if (!text.empty()) {
+            std::memcpy(bytes, text.data(), text.size());
+        }
+        return arena_view{ *this, std::string_view{ bytes, text.size() } };
+    }
+
+    // arithmetic is disabled: concatenation would need an arena
+    template<typename DimType, typename Limitations = limitations<false, true, true>>
+    using arena_singleton = singleton<arena_view, DimType, Limitations>;
+}
+
+namespace std
+{
+    template<>
+    struct hash<safe_types::arena_view>
+    {
+        size_t operator()(const safe_types::arena_view& value) const noexcept
+        {
+            return std::hash<std::string_view>{}(value.view());
+        }
+    };
+}
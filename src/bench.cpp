@@ -0,0 +1,855 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arena.h"
+#include "charconv.h"
+#include "convert.h"
+#include "fixed_string.h"
+#include "flat_map.h"
+#include "format.h"
+#include "functional.h"
+#include "hashed_string.h"
+#include "interned.h"
+#include "physical_types.h"
+#include "quantity_vector.h"
+#include "serialize.h"
+#include "slot_map.h"
+#include "typed_vector.h"
+
+namespace
+{
+    constexpr size_t element_count = 1 << 20;
+    constexpr size_t string_count = 1 << 16;
+    constexpr size_t repetitions = 20;
+
+    // keeps the optimizer from dropping the measured work
+    volatile long long sink = 0;
+
+    struct result
+    {
+        std::string group;
+        std::string name;
+        double ns_per_element;
+    };
+
+    std::vector<result> results;
+
+    void record(const char* group, const char* name, double ns_per_element)
+    {
+        results.push_back(result{ group, name, ns_per_element });
+    }
+
+    long long raw_value(long long value)
+    {
+        return value;
+    }
+
+    long long raw_value(const std::string& value)
+    {
+        return static_cast<long long>(value.size());
+    }
+
+    long long raw_value(const safe_types::hashed_string& value)
+    {
+        return static_cast<long long>(value.size());
+    }
+
+    template<size_t N>
+    long long raw_value(const safe_types::fixed_string<N>& value)
+    {
+        return static_cast<long long>(value.size());
+    }
+
+    template<typename Tag>
+    long long raw_value(const safe_types::interned_string<Tag>& value)
+    {
+        return static_cast<long long>(value.str().size());
+    }
+
+    template<typename Rep, typename Period>
+    long long raw_value(const std::chrono::duration<Rep, Period>& value)
+    {
+        return static_cast<long long>(value.count());
+    }
+
+    template<typename CT, typename = typename CT::underlying_type>
+    long long raw_value(const CT& ct)
+    {
+        return raw_value(ct.value());
+    }
+
+    template<typename F>
+    double measure_ns_per_element(size_t count, F&& f)
+    {
+        auto best = std::chrono::nanoseconds::max();
+        for (size_t i = 0; i < repetitions; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            f();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            best = std::min(best, elapsed);
+        }
+        return static_cast<double>(best.count()) / count;
+    }
+
+    template<typename T>
+    double bench_vector_copy(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            std::vector<T> copy(source);
+            sink = sink + raw_value(copy[copy.size() / 2]);
+        });
+    }
+
+    template<typename T>
+    double bench_add(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            T total{};
+            for (const auto& value : source) {
+                total += value;
+            }
+            sink = sink + raw_value(total);
+        });
+    }
+
+    template<typename T>
+    double bench_compare(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            long long less = 0;
+            for (size_t i = 1; i < source.size(); ++i) {
+                less += source[i - 1] < source[i] ? 1 : 0;
+            }
+            sink = sink + less;
+        });
+    }
+
+    template<typename T>
+    double bench_equal(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            long long equal = 0;
+            for (size_t i = 1; i < source.size(); ++i) {
+                equal += source[i - 1] == source[i] ? 1 : 0;
+            }
+            sink = sink + equal;
+        });
+    }
+
+    template<typename T>
+    double bench_hash(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            size_t total = 0;
+            for (const auto& value : source) {
+                total += std::hash<T>{}(value);
+            }
+            sink = sink + static_cast<long long>(total);
+        });
+    }
+
+    // the transparent hash, which normalizes the value to base units
+    template<typename T>
+    double bench_transparent_hash(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            size_t total = 0;
+            for (const auto& value : source) {
+                total += safe_types::hash<>{}(value);
+            }
+            sink = sink + static_cast<long long>(total);
+        });
+    }
+
+    // lookups of probes of another unit in one set, so that the three ways walk the same nodes:
+    // a converted key per lookup, the transparent comparator, or a probe_key
+    template<typename Key, typename Probe>
+    double bench_set_find_converted(const std::set<Key, safe_types::less<>>& keys, const std::vector<Probe>& probes)
+    {
+        return measure_ns_per_element(probes.size(), [&keys, &probes]() {
+            long long found = 0;
+            for (const auto& probe : probes) {
+                found += keys.find(Key(probe)) != keys.end() ? 1 : 0;
+            }
+            sink = sink + found;
+        });
+    }
+
+    template<typename Key, typename Probe>
+    double bench_set_find_transparent(const std::set<Key, safe_types::less<>>& keys, const std::vector<Probe>& probes)
+    {
+        return measure_ns_per_element(probes.size(), [&keys, &probes]() {
+            long long found = 0;
+            for (const auto& probe : probes) {
+                found += keys.find(probe) != keys.end() ? 1 : 0;
+            }
+            sink = sink + found;
+        });
+    }
+
+    template<typename Key, typename Probe>
+    double bench_set_find_probe(const std::set<Key, safe_types::less<>>& keys, const std::vector<Probe>& probes)
+    {
+        return measure_ns_per_element(probes.size(), [&keys, &probes]() {
+            long long found = 0;
+            for (const auto& probe : probes) {
+                found += keys.find(safe_types::probe<Key>(probe)) != keys.end() ? 1 : 0;
+            }
+            sink = sink + found;
+        });
+    }
+
+    // inserts and finds in a linear-probing table of twice the key count, indexed by the low
+    // hash bits, i.e. the access pattern of open-addressing maps
+    template<typename Key>
+    double bench_open_addressing(const std::vector<Key>& keys)
+    {
+        const size_t mask = keys.size() * 2 - 1;
+        std::vector<Key> slots(mask + 1);
+        std::vector<char> used(mask + 1);
+        return measure_ns_per_element(keys.size(), [&]() {
+            std::fill(used.begin(), used.end(), 0);
+            long long probes = 0;
+            for (const auto& key : keys) {
+                size_t slot = std::hash<Key>{}(key) & mask;
+                for (; used[slot]; slot = (slot + 1) & mask) {
+                    ++probes;
+                }
+                used[slot] = 1;
+                slots[slot] = key;
+            }
+            for (const auto& key : keys) {
+                size_t slot = std::hash<Key>{}(key) & mask;
+                for (; !(slots[slot] == key); slot = (slot + 1) & mask) {
+                    ++probes;
+                }
+            }
+            sink = sink + probes;
+        });
+    }
+
+    // splits "tenant=<id> path=<path>" lines into two strong-typed fields
+    template<typename Tenant, typename Path, typename MakeField>
+    double bench_parse(const std::string& input, size_t lines, MakeField&& make_field)
+    {
+        return measure_ns_per_element(lines, [&]() {
+            std::vector<std::pair<Tenant, Path>> fields;
+            fields.reserve(lines);
+            const std::string_view text = make_field.input(input);
+            size_t begin = 0;
+            while (begin < text.size()) {
+                const size_t end = text.find('\n', begin);
+                const auto line = text.substr(begin, end - begin);
+                const size_t space = line.find(' ');
+                fields.emplace_back(
+                    Tenant{ make_field(line.substr(7, space - 7)) },
+                    Path{ make_field(line.substr(space + 6)) });
+                begin = end + 1;
+            }
+            sink = sink + static_cast<long long>(fields.size());
+        });
+    }
+
+    struct string_fields
+    {
+        std::string_view input(const std::string& text) const
+        {
+            return text;
+        }
+
+        std::string operator()(std::string_view field) const
+        {
+            return std::string{ field };
+        }
+    };
+
+    // the input is copied into the arena once per pass, the fields are views of that copy
+    struct arena_fields
+    {
+        safe_types::string_arena& arena;
+
+        std::string_view input(const std::string& text)
+        {
+            arena.reset();
+            return arena.store(text).view();
+        }
+
+        safe_types::arena_view operator()(std::string_view field) const
+        {
+            return arena.view(field);
+        }
+    };
+
+    // builds a map from keys, then looks up every key and as many absent ones
+    template<typename Map, typename Key>
+    double bench_map(const std::vector<Key>& keys, const std::vector<Key>& absent)
+    {
+        return measure_ns_per_element(keys.size(), [&keys, &absent]() {
+            Map map;
+            long long total = 0;
+            for (const auto& key : keys) {
+                map[key] = raw_value(key);
+            }
+            for (const auto& key : keys) {
+                total += map.find(key)->second;
+            }
+            for (const auto& key : absent) {
+                total += map.find(key) == map.end() ? 1 : 0;
+            }
+            sink = sink + total;
+        });
+    }
+
+    // sums the values found for keys, in the given (shuffled) order
+    template<typename Keys, typename Lookup>
+    double bench_lookup(const Keys& keys, Lookup lookup)
+    {
+        return measure_ns_per_element(keys.size(), [&keys, &lookup]() {
+            long long total = 0;
+            for (const auto& key : keys) {
+                total += lookup(key);
+            }
+            sink = sink + total;
+        });
+    }
+
+    // formats every value with its unit into one reused buffer
+    template<typename Format, typename T>
+    double bench_format(const std::vector<T>& values, Format format)
+    {
+        return measure_ns_per_element(values.size(), [&values, &format]() {
+            long long total = 0;
+            for (const auto& value : values) {
+                total += format(value);
+            }
+            sink = sink + total;
+        });
+    }
+
+    // reads one duration per line into milliseconds
+    template<typename ParseLine>
+    double bench_parse_durations(const std::string& input, size_t lines, ParseLine parse_line)
+    {
+        return measure_ns_per_element(lines, [&input, &parse_line]() {
+            long long total = 0;
+            const char* begin = input.data();
+            const char* const end = input.data() + input.size();
+            while (begin < end) {
+                const char* line_end = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+                total += parse_line(begin, line_end).value();
+                begin = line_end + 1;
+            }
+            sink = sink + total;
+        });
+    }
+
+    // the hand-written parsing from_chars replaces: strtod, then a chain of suffix compares
+    safe_types::milliseconds parse_duration_by_hand(const char* begin, const char* end)
+    {
+        char* suffix = nullptr;
+        const double number = std::strtod(begin, &suffix);
+        const std::string_view unit{ suffix, static_cast<size_t>(end - suffix) };
+        double scale = 0;
+        if (unit == "ns") {
+            scale = 1e-6;
+        }
+        else if (unit == "us") {
+            scale = 1e-3;
+        }
+        else if (unit == "ms") {
+            scale = 1;
+        }
+        else if (unit == "s") {
+            scale = 1e3;
+        }
+        else if (unit == "min") {
+            scale = 6e4;
+        }
+        else if (unit == "h") {
+            scale = 3.6e6;
+        }
+        return safe_types::milliseconds{ static_cast<long long>(number * scale) };
+    }
+
+    template<typename T>
+    double bench_sort(const std::vector<T>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            std::vector<T> sorted(source);
+            std::sort(sorted.begin(), sorted.end());
+            sink = sink + raw_value(sorted[sorted.size() / 2]);
+        });
+    }
+
+    template<typename To, typename From>
+    double bench_cast(const std::vector<From>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            long long total = 0;
+            for (const auto& value : source) {
+                total += raw_value(To(value));
+            }
+            sink = sink + total;
+        });
+    }
+
+    template<intmax_t Num, intmax_t Den>
+    double bench_raw_scale(const std::vector<long long>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            long long total = 0;
+            for (const auto value : source) {
+                total += value * Num / Den;
+            }
+            sink = sink + total;
+        });
+    }
+
+    template<typename To, typename Rep, typename Period>
+    double bench_duration_cast(const std::vector<std::chrono::duration<Rep, Period>>& source)
+    {
+        return measure_ns_per_element(source.size(), [&source]() {
+            long long total = 0;
+            for (const auto& value : source) {
+                total += std::chrono::duration_cast<To>(value).count();
+            }
+            sink = sink + total;
+        });
+    }
+
+    template<typename From, typename To>
+    double bench_convert_scalar(const std::vector<From>& source, std::vector<To>& target)
+    {
+        using from_und_type = typename From::underlying_type;
+        using to_und_type = typename To::underlying_type;
+        return measure_ns_per_element(source.size(), [&source, &target]() {
+            safe_types::internal::convert_scalar<to_und_type, typename From::period, typename To::period>(
+                reinterpret_cast<const from_und_type*>(source.data()), reinterpret_cast<to_und_type*>(target.data()), source.size());
+            sink = sink + static_cast<long long>(target[target.size() / 2].value());
+        });
+    }
+
+    template<typename From, typename To>
+    double bench_convert(const std::vector<From>& source, std::vector<To>& target)
+    {
+        return measure_ns_per_element(source.size(), [&source, &target]() {
+            safe_types::convert(safe_types::span<const From>{ source }, safe_types::span<To>{ target });
+            sink = sink + static_cast<long long>(target[target.size() / 2].value());
+        });
+    }
+
+    // the same conversion with the ratio hidden from the optimizer, i.e. with a hardware divide
+    volatile intmax_t opaque_one = 1;
+
+    template<typename From, typename To>
+    double bench_cast_divide(const std::vector<From>& source)
+    {
+        using coef = std::ratio_divide<typename From::period, typename To::period>;
+        return measure_ns_per_element(source.size(), [&source]() {
+            const intmax_t num = coef::num * opaque_one;
+            const intmax_t den = coef::den * opaque_one;
+            long long total = 0;
+            for (const auto& value : source) {
+                total += value.value() * num / den;
+            }
+            sink = sink + total;
+        });
+    }
+
+    template<typename From, typename To>
+    void record_cast(const char* name, const std::vector<From>& source)
+    {
+        record("cast", name, bench_cast<To>(source));
+        record("cast_hardware_divide", name, bench_cast_divide<From, To>(source));
+    }
+
+    // operations shared by every numeric representation (std::hash has no duration specialization)
+    template<typename T>
+    void record_numeric(const char* name, const std::vector<T>& values)
+    {
+        record("add", name, bench_add(values));
+        record("compare", name, bench_compare(values));
+        record("sort", name, bench_sort(values));
+        record("vector_copy", name, bench_vector_copy(values));
+    }
+
+    // building a set rehashes every key as it grows, then every key is looked up
+    template<typename T>
+    double bench_unordered_set(const std::vector<T>& values)
+    {
+        return measure_ns_per_element(values.size(), [&values]() {
+            std::unordered_set<T> set;
+            for (const auto& value : values) {
+                set.insert(value);
+            }
+            long long found = 0;
+            for (const auto& value : values) {
+                found += static_cast<long long>(set.count(value));
+            }
+            sink = sink + found;
+        });
+    }
+
+    template<typename T>
+    void record_string(const char* name, const std::vector<T>& values)
+    {
+        record("compare", name, bench_compare(values));
+        record("equal", name, bench_equal(values));
+        record("hash", name, bench_hash(values));
+        record("unordered_set", name, bench_unordered_set(values));
+        record("sort", name, bench_sort(values));
+        record("vector_copy", name, bench_vector_copy(values));
+    }
+
+    // pseudo-random but reproducible input, so sort and compare do not see a presorted sequence
+    std::vector<long long> make_raw_values(size_t count)
+    {
+        std::vector<long long> values(count);
+        unsigned long long state = 88172645463325252ULL;
+        for (auto& value : values) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value = static_cast<long long>(state % 1000000000ULL);
+        }
+        return values;
+    }
+
+    template<typename T>
+    struct identity
+    {
+        using type = T;
+    };
+
+    template<typename T>
+    std::vector<T> wrap(const std::vector<long long>& raw)
+    {
+        std::vector<T> values;
+        values.reserve(raw.size());
+        for (const auto value : raw) {
+            values.push_back(T{ value });
+        }
+        return values;
+    }
+
+    void print_json()
+    {
+        std::printf("{\n  \"element_count\": %zu,\n  \"string_count\": %zu,\n  \"benchmarks\": [\n", element_count, string_count);
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::printf("    { \"group\": \"%s\", \"name\": \"%s\", \"ns_per_element\": %.4f }%s\n",
+                results[i].group.c_str(), results[i].name.c_str(), results[i].ns_per_element, i + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+}
+
+int main()
+{
+    const auto raw = make_raw_values(element_count);
+    const auto meters = wrap<safe_types::meters>(raw);
+    const auto milliseconds = wrap<safe_types::milliseconds>(raw);
+    const auto chrono_milliseconds = wrap<std::chrono::milliseconds>(raw);
+    const auto bytes = wrap<safe_types::bytes>(raw);
+
+    record_numeric("long long", raw);
+    record_numeric("meters", meters);
+    record_numeric("milliseconds", milliseconds);
+    record_numeric("std::chrono::milliseconds", chrono_milliseconds);
+    record_numeric("bytes", bytes);
+    record("hash", "long long", bench_hash(raw));
+    record("hash", "meters", bench_hash(meters));
+    record("hash", "milliseconds", bench_hash(milliseconds));
+    record("hash", "bytes", bench_hash(bytes));
+    record("hash", "milliseconds (hash<>)", bench_transparent_hash(milliseconds));
+    const auto inches_hashed = wrap<safe_types::inches>(raw);
+    record("hash", "inches", bench_hash(inches_hashed));
+    record("hash", "inches (hash<>)", bench_transparent_hash(inches_hashed));
+
+    // the 64k-node set is bound by node cache misses; the 1k-node set stays in cache, where the cost
+    // of the comparisons shows
+    for (const size_t set_size : { string_count, size_t{ 1024 } }) {
+        const char* const group = set_size == string_count ? "set_find" : "set_find (1k keys, cached)";
+        const std::set<safe_types::meters, safe_types::less<>> meter_set(meters.begin(), meters.begin() + set_size);
+        std::vector<safe_types::kilometers> kilometer_probes;
+        std::vector<safe_types::millimeters> millimeter_probes;
+        for (size_t i = 0; i < string_count; ++i) {
+            const long long value = raw[i % set_size];
+            kilometer_probes.push_back(safe_types::kilometers{ value / 1000 });
+            millimeter_probes.push_back(safe_types::millimeters{ value * 1000 });
+        }
+        record(group, "km in meters, converted key", bench_set_find_converted(meter_set, kilometer_probes));
+        record(group, "km in meters, transparent less", bench_set_find_transparent(meter_set, kilometer_probes));
+        record(group, "km in meters, probe", bench_set_find_probe(meter_set, kilometer_probes));
+        record(group, "mm in meters, converted key", bench_set_find_converted(meter_set, millimeter_probes));
+        record(group, "mm in meters, transparent less", bench_set_find_transparent(meter_set, millimeter_probes));
+        record(group, "mm in meters, probe", bench_set_find_probe(meter_set, millimeter_probes));
+    }
+
+    // strided IDs, as handed out by sharded allocators
+    class UserIdDim;
+    using identity_id = safe_types::singleton<unsigned long long, UserIdDim>;
+    using multiplicative_id = safe_types::singleton<unsigned long long, UserIdDim, safe_types::limitations<true, true, true, safe_types::multiplicative_hash>>;
+    using wy_id = safe_types::singleton<unsigned long long, UserIdDim, safe_types::limitations<true, true, true, safe_types::wy_hash>>;
+    using salted_id = safe_types::singleton<unsigned long long, UserIdDim, safe_types::limitations<true, true, true, safe_types::salted_hash<>>>;
+    std::vector<unsigned long long> strided_ids(string_count);
+    for (size_t i = 0; i < strided_ids.size(); ++i) {
+        strided_ids[i] = i * 64;
+    }
+    const auto wrap_ids = [&strided_ids](auto tag) {
+        using id = typename decltype(tag)::type;
+        std::vector<id> ids;
+        for (const auto value : strided_ids) {
+            ids.push_back(id{ value });
+        }
+        return ids;
+    };
+    record("open_addressing", "identity_hash", bench_open_addressing(wrap_ids(identity<identity_id>{})));
+    record("open_addressing", "multiplicative_hash", bench_open_addressing(wrap_ids(identity<multiplicative_id>{})));
+    record("open_addressing", "wy_hash", bench_open_addressing(wrap_ids(identity<wy_id>{})));
+    record("open_addressing", "salted_hash<wy_hash>", bench_open_addressing(wrap_ids(identity<salted_id>{})));
+
+    class OrderIdDim;
+    using order_id = safe_types::singleton<long long, OrderIdDim>;
+    const auto order_ids = wrap<order_id>(raw);
+    std::vector<order_id> absent_ids;
+    for (const auto value : raw) {
+        absent_ids.push_back(order_id{ -value - 1 });
+    }
+    record("map", "std::unordered_map", bench_map<std::unordered_map<order_id, long long>>(order_ids, absent_ids));
+    record("map", "flat_map", bench_map<safe_types::flat_map<order_id, long long>>(order_ids, absent_ids));
+
+    record("to_chars", "std::ostringstream", bench_format(milliseconds, [](const safe_types::milliseconds& value) {
+        std::ostringstream stream;
+        static_cast<std::ostream&>(stream) << value << "ms";
+        return static_cast<long long>(stream.str().size());
+    }));
+    std::ostringstream reused_stream;
+    record("to_chars", "std::ostringstream (reused)", bench_format(milliseconds, [&reused_stream](const safe_types::milliseconds& value) {
+        reused_stream.str(std::string{});
+        static_cast<std::ostream&>(reused_stream) << value << "ms";
+        return static_cast<long long>(reused_stream.tellp());
+    }));
+    record("to_chars", "safe_types::to_chars", bench_format(milliseconds, [](const safe_types::milliseconds& value) {
+        char buffer[32];
+        return static_cast<long long>(safe_types::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+    }));
+    // dashboard formatting of byte counts: scaled by hand and streamed, or to_chars with auto-scale
+    record("to_chars", "std::ostringstream + manual scaling", bench_format(bytes, [](const safe_types::bytes& value) {
+        const char* const units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+        double scaled = static_cast<double>(value.value());
+        size_t unit = 0;
+        while (scaled >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+            scaled /= 1024;
+            ++unit;
+        }
+        std::ostringstream stream;
+        stream.precision(3);
+        stream << scaled << units[unit];
+        return static_cast<long long>(stream.str().size());
+    }));
+    safe_types::quantity_format auto_scale;
+    auto_scale.auto_scale = true;
+    record("to_chars", "safe_types::to_chars (auto scale)", bench_format(bytes, [&auto_scale](const safe_types::bytes& value) {
+        char buffer[48];
+        return static_cast<long long>(safe_types::to_chars(buffer, buffer + sizeof(buffer), value, auto_scale).ptr - buffer);
+    }));
+
+    using gibibytes_type = safe_types::simple_type<double, std::ratio<1073741824>, safe_types::MemoryVolumeDim>;
+    std::vector<gibibytes_type> gibibytes;
+    for (const auto value : raw) {
+        gibibytes.push_back(gibibytes_type{ static_cast<double>(value) / 1000 });
+    }
+    record("to_chars", "std::ostringstream (double)", bench_format(gibibytes, [](const auto& value) {
+        std::ostringstream stream;
+        static_cast<std::ostream&>(stream) << value << "GiB";
+        return static_cast<long long>(stream.str().size());
+    }));
+    record("to_chars", "safe_types::to_chars (double)", bench_format(gibibytes, [](const auto& value) {
+        char buffer[48];
+        return static_cast<long long>(safe_types::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+    }));
+
+    // one million config-style lines such as "250ms", "1.5s", "3min", mostly integral
+    const char* const duration_units[] = { "ns", "us", "ms", "s", "min", "h" };
+    std::string durations;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char line[48];
+        const long long value = raw[i] % 100000;
+        const int length = i % 8 == 0
+            ? std::snprintf(line, sizeof(line), "%lld.%llds\n", value / 1000, value % 1000 / 100)
+            : std::snprintf(line, sizeof(line), "%lld%s\n", value, duration_units[i % 6]);
+        durations.append(line, static_cast<size_t>(length));
+    }
+    record("from_chars", "strtod + suffix compares", bench_parse_durations(durations, raw.size(), parse_duration_by_hand));
+    record("from_chars", "safe_types::from_chars", bench_parse_durations(durations, raw.size(), [](const char* begin, const char* end) {
+        safe_types::milliseconds value;
+        safe_types::from_chars(begin, end, value);
+        return value;
+    }));
+
+    // encoded once; decoding into the stored unit is one memcpy, into another unit a conversion
+    safe_types::quantity_vector<safe_types::milliseconds> stored_latencies;
+    for (const auto& value : milliseconds) {
+        stored_latencies.push_back(value);
+    }
+    std::vector<char> encoded(safe_types::encoded_size<safe_types::milliseconds>(stored_latencies.size()));
+    record("serialize", "encode", measure_ns_per_element(stored_latencies.size(), [&stored_latencies, &encoded]() {
+        sink = sink + (safe_types::encode(encoded.data(), encoded.data() + encoded.size(), stored_latencies).ptr - encoded.data());
+    }));
+    record("serialize", "decode (same unit)", measure_ns_per_element(stored_latencies.size(), [&encoded]() {
+        safe_types::quantity_vector<safe_types::milliseconds> values;
+        safe_types::decode(encoded.data(), encoded.data() + encoded.size(), values);
+        sink = sink + values[values.size() / 2].value();
+    }));
+    record("serialize", "decode (ms -> us)", measure_ns_per_element(stored_latencies.size(), [&encoded]() {
+        safe_types::quantity_vector<safe_types::microseconds> values;
+        safe_types::decode(encoded.data(), encoded.data() + encoded.size(), values);
+        sink = sink + values[values.size() / 2].value();
+    }));
+    record("serialize", "decode (ms -> s)", measure_ns_per_element(stored_latencies.size(), [&encoded]() {
+        safe_types::quantity_vector<safe_types::seconds> values;
+        safe_types::decode(encoded.data(), encoded.data() + encoded.size(), values);
+        sink = sink + values[values.size() / 2].value();
+    }));
+
+    class NodeIdDim;
+    using node_id = safe_types::singleton<uint32_t, NodeIdDim>;
+    safe_types::typed_vector<node_id, long long> node_table;
+    std::unordered_map<node_id, long long> node_hash_table;
+    safe_types::slot_map<node_id, long long> node_slots;
+    std::vector<node_id> node_ids;
+    std::vector<safe_types::generational_id<node_id>> node_keys;
+    for (const auto value : raw) {
+        const node_id id = node_table.push_back(value);
+        node_hash_table.emplace(id, value);
+        node_slots.insert(value);
+        node_ids.push_back(id);
+    }
+    // erase and reinsert every other element, so slot and value order differ
+    for (size_t i = 0; i < node_slots.size(); i += 2) {
+        const auto key = node_slots.key_at(i);
+        const long long value = node_slots[key];
+        node_slots.erase(key);
+        node_slots.insert(value);
+    }
+    for (size_t i = 0; i < node_slots.size(); ++i) {
+        node_keys.push_back(node_slots.key_at(i));
+    }
+    std::shuffle(node_ids.begin(), node_ids.end(), std::mt19937_64{ 7 });
+    std::shuffle(node_keys.begin(), node_keys.end(), std::mt19937_64{ 7 });
+    record("dense_lookup", "std::vector (raw index)", bench_lookup(node_ids, [&node_table](node_id id) {
+        return node_table.data()[id.value()];
+    }));
+    record("dense_lookup", "typed_vector", bench_lookup(node_ids, [&node_table](node_id id) {
+        return node_table[id];
+    }));
+    record("dense_lookup", "std::unordered_map", bench_lookup(node_ids, [&node_hash_table](node_id id) {
+        return node_hash_table.find(id)->second;
+    }));
+    record("dense_lookup", "slot_map", bench_lookup(node_keys, [&node_slots](const safe_types::generational_id<node_id>& key) {
+        return node_slots[key];
+    }));
+
+    class StringDim;
+    using safe_string = safe_types::singleton<std::string, StringDim>;
+    std::vector<std::string> strings;
+    std::vector<safe_string> safe_strings;
+    for (size_t i = 0; i < string_count; ++i) {
+        strings.push_back("identifier-" + std::to_string(raw[i]));
+        safe_strings.push_back(safe_string{ strings.back() });
+    }
+    record_string("std::string", strings);
+    record_string("singleton<std::string>", safe_strings);
+    std::vector<safe_types::hashed_singleton<StringDim>> hashed_strings;
+    for (const auto& value : strings) {
+        hashed_strings.emplace_back(value);
+    }
+    record_string("hashed_singleton", hashed_strings);
+    std::vector<safe_types::singleton<safe_types::fixed_string<24>, StringDim>> fixed_strings;
+    for (const auto& value : strings) {
+        fixed_strings.emplace_back(safe_types::fixed_string<24>{ value });
+    }
+    record_string("singleton<fixed_string<24>>", fixed_strings);
+
+    class TenantDim;
+    class PathDim;
+    std::string request_lines;
+    for (size_t i = 0; i < string_count; ++i) {
+        request_lines += "tenant=tenant-" + std::to_string(raw[i] % 1000) + " path=/api/v1/objects/" + std::to_string(raw[i]) + "\n";
+    }
+    record("parse", "singleton<std::string>", bench_parse<safe_types::singleton<std::string, TenantDim>, safe_types::singleton<std::string, PathDim>>(
+        request_lines, string_count, string_fields{}));
+    safe_types::string_arena arena{ request_lines.size() };
+    record("parse", "arena_singleton", bench_parse<safe_types::arena_singleton<TenantDim>, safe_types::arena_singleton<PathDim>>(
+        request_lines, string_count, arena_fields{ arena }));
+
+    // repeated values, as in tenant columns: every distinct string appears 16 times
+    std::vector<safe_string> repeated_strings;
+    std::vector<safe_types::interned<StringDim>> interned_strings;
+    for (size_t i = 0; i < string_count; ++i) {
+        repeated_strings.push_back(safe_strings[i % (string_count / 16)]);
+    }
+    record("intern", "interned", measure_ns_per_element(string_count, [&]() {
+        interned_strings.clear();
+        for (const auto& value : repeated_strings) {
+            interned_strings.emplace_back(value.value());
+        }
+        sink = sink + raw_value(interned_strings.back());
+    }));
+    record_string("repeated singleton<std::string>", repeated_strings);
+    record_string("repeated interned", interned_strings);
+
+    record("cast", "long long ms->us", bench_raw_scale<1000, 1>(raw));
+    record("cast", "milliseconds->microseconds", bench_cast<safe_types::microseconds>(milliseconds));
+    record("cast", "std::chrono ms->us", bench_duration_cast<std::chrono::microseconds>(chrono_milliseconds));
+    record("cast", "long long us->ms", bench_raw_scale<1, 1000>(raw));
+    record("cast", "microseconds->milliseconds", bench_cast<safe_types::milliseconds>(wrap<safe_types::microseconds>(raw)));
+    record("cast", "std::chrono us->ms", bench_duration_cast<std::chrono::milliseconds>(wrap<std::chrono::microseconds>(raw)));
+
+    record_cast<safe_types::meters, safe_types::inches>("m->in", meters);
+    record_cast<safe_types::meters, safe_types::feet>("m->ft", meters);
+    record_cast<safe_types::meters, safe_types::yards>("m->yd", meters);
+    record_cast<safe_types::meters, safe_types::miles>("m->mi", meters);
+    const auto inches = wrap<safe_types::inches>(raw);
+    record_cast<safe_types::inches, safe_types::meters>("in->m", inches);
+    record_cast<safe_types::inches, safe_types::feet>("in->ft", inches);
+    const auto miles = wrap<safe_types::miles>(raw);
+    record_cast<safe_types::miles, safe_types::meters>("mi->m", miles);
+    record_cast<safe_types::miles, safe_types::yards>("mi->yd", miles);
+    record_cast<safe_types::miles, safe_types::micrometers>("mi->um (wide)", miles);
+
+    std::vector<safe_types::millimeters> millimeters(element_count);
+    record("convert_scalar", "m->mm", bench_convert_scalar(meters, millimeters));
+    record("convert", "m->mm", bench_convert(meters, millimeters));
+    std::vector<safe_types::meters> meters_back(element_count);
+    record("convert_scalar", "mm->m", bench_convert_scalar(millimeters, meters_back));
+    record("convert", "mm->m", bench_convert(millimeters, meters_back));
+    std::vector<safe_types::kilobytes> kilobytes(element_count);
+    record("convert_scalar", "B->KiB", bench_convert_scalar(bytes, kilobytes));
+    record("convert", "B->KiB", bench_convert(bytes, kilobytes));
+
+    class TimeDim;
+    using real_seconds = safe_types::simple_type<double, std::ratio<1>, TimeDim>;
+    using real_hours = safe_types::simple_type<double, std::ratio<3600>, TimeDim>;
+    std::vector<real_seconds> seconds;
+    for (const auto value : raw) {
+        seconds.push_back(real_seconds{ static_cast<double>(value) * 1.5 });
+    }
+    std::vector<real_hours> hours(element_count);
+    record("convert_scalar", "double s->h", bench_convert_scalar(seconds, hours));
+    record("convert", "double s->h", bench_convert(seconds, hours));
+
+    print_json();
+    return 0;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "safe_types.h"
+#include "unit_symbol.h"
+
+namespace safe_types
+{
+    namespace internal
+    {
+        template<typename UT>
+        using to_chars_enabled = std::enable_if_t<std::is_arithmetic<UT>::value && !std::is_same<UT, bool>::value>;
+
+        template<typename CT>
+        std::to_chars_result append_symbol(std::to_chars_result number, char* last) noexcept
+        {
+            constexpr std::string_view symbol = unit_symbol_v<CT>;
+            if (number.ec != std::errc{}) {
+                return number;
+            }
+            if (static_cast<size_t>(last - number.ptr) < symbol.size()) {
+                return std::to_chars_result{ last, std::errc::value_too_large };
+            }
+            for (const char c : symbol) {
+                *number.ptr++ = c;
+            }
+            return number;
+        }
+
+        // the number before the unit symbol: integral when written without fraction or exponent;
+        // unsigned underlying types read the integer as uintmax_t so that the whole range parses
+        template<typename UT>
+        struct parsed_number
+        {
+            std::conditional_t<std::is_unsigned<UT>::value, uintmax_t, intmax_t> integer;
+            double real;
+            bool integral;
+        };
+
+        // false when the converted value does not fit the underlying type of CT
+        template<typename CT, typename From>
+        bool convert_number(const parsed_number<typename CT::underlying_type>& number, CT& ct) noexcept
+        {
+            using UT = typename CT::underlying_type;
+            using from = typename From::period;
+            using to = typename CT::period;
+            if (number.integral) {
+                if (!cast_fits<UT, from, to>(number.integer)) {
+                    return false;
+                }
+                ct = CT{ cast_value<UT, from, to>(number.integer) };
+            }
+            else {
+                if (!cast_fits<UT, from, to>(number.real)) {
+                    return false;
+                }
+                ct = CT{ cast_value<UT, from, to>(number.real) };
+            }
+            return true;
+        }
+
+        template<typename CT>
+        using convert_number_t = bool (*)(const parsed_number<typename CT::underlying_type>&, CT&);
+
+        // the longest symbol of CT or of a unit of its dimension that starts the text, and the conversion
+        // from that unit; first when none matches
+        template<typename CT, typename... Units>
+        const char* match_symbol(const char* first, const char* last, unit_list<Units...>, convert_number_t<CT>& convert) noexcept
+        {
+            static_assert((std::is_same<typename Units::dimensions, typename CT::dimensions>::value && ...),
+                "dimension_units lists units of another dimension");
+            const std::string_view text{ first, static_cast<size_t>(last - first) };
+            size_t matched = 0;
+            const auto consider = [&text, &matched, &convert](std::string_view symbol, convert_number_t<CT> from) {
+                if (symbol.size() > matched && text.substr(0, symbol.size()) == symbol) {
+                    matched = symbol.size();
+                    convert = from;
+                }
+            };
+            consider(unit_symbol_v<CT>, &convert_number<CT, CT>);
+            (consider(unit_symbol_v<Units>, &convert_number<CT, Units>), ...);
+            return first + matched;
+        }
+    }
+
+    // writes the value followed by its unit symbol ("1500ms", "3.2GiB") with the contract of
+    // std::to_chars: no allocation, no locale, and {last, std::errc::value_too_large} when the
+    // text does not fit. Floating point values use the shortest text that reads back exactly
+    template<typename UT, typename Ratio, typename DimRatio, typename Limitations, typename = internal::to_chars_enabled<UT>>
+    std::to_chars_result to_chars(char* first, char* last, const complex_type<UT, Ratio, DimRatio, Limitations>& ct) noexcept
+    {
+        using type = complex_type<UT, Ratio, DimRatio, Limitations>;
+        return internal::append_symbol<type>(std::to_chars(first, last, ct.value()), last);
+    }
+
+    template<typename UT, typename Ratio, typename DimRatio, typename Limitations,
+        typename = std::enable_if_t<std::is_floating_point<UT>::value>>
+    std::to_chars_result to_chars(char* first, char* last, const complex_type<UT, Ratio, DimRatio, Limitations>& ct,
+        std::chars_format format, int precision) noexcept
+    {
+        using type = complex_type<UT, Ratio, DimRatio, Limitations>;
+        return internal::append_symbol<type>(std::to_chars(first, last, ct.value(), format, precision), last);
+    }
+
+    // reads a number followed by a unit symbol of the dimension of CT ("250ms", "1.5s", "12.5km", "4GiB")
+    // and converts it to the unit of CT with the rounding of cast; no allocation, no locale, no
+    // whitespace. Units without a symbol read a bare number. Like std::from_chars, ptr is past the
+    // matched symbol; errors are invalid_argument (no number or unknown symbol) and result_out_of_range
+    // (the number or the converted value does not fit, or is negative for an unsigned underlying type),
+    // which leaves ct unchanged
+    template<typename UT, typename Ratio, typename DimRatio, typename Limitations, typename = internal::to_chars_enabled<UT>>
+    std::from_chars_result from_chars(const char* first, const char* last, complex_type<UT, Ratio, DimRatio, Limitations>& ct) noexcept
+    {
+        using type = complex_type<UT, Ratio, DimRatio, Limitations>;
+        internal::parsed_number<UT> number{ 0, 0.0, std::is_integral<UT>::value };
+        // std::from_chars reads no sign into an unsigned integer, so the minus sign is skipped here
+        // and anything but zero after it is out of range
+        const bool negative = std::is_unsigned<UT>::value && first != last && *first == '-';
+        const char* end = first;
+        if (number.integral) {
+            const auto integer = std::from_chars(negative ? first + 1 : first, last, number.integer);
+            if (integer.ec == std::errc::invalid_argument) {
+                return std::from_chars_result{ first, integer.ec };
+            }
+            if (integer.ec != std::errc{}) {
+                return integer;
+            }
+            end = integer.ptr;
+            number.integral = end == last || (*end != '.' && *end != 'e' && *end != 'E');
+        }
+        if (!number.integral) {
+            const auto real = std::from_chars(first, last, number.real);
+            if (real.ec != std::errc{}) {
+                return real;
+            }
+            end = real.ptr;
+        }
+        if (std::is_unsigned<UT>::value && (number.integral ? negative && number.integer != 0 : number.real < 0)) {
+            return std::from_chars_result{ end, std::errc::result_out_of_range };
+        }
+
+        internal::convert_number_t<type> convert = nullptr;
+        const char* symbol_end = internal::match_symbol<type>(end, last, typename dimension_units<DimRatio>::type{}, convert);
+        if (convert == nullptr) {
+            if (!unit_symbol_v<type>.empty()) {
+                return std::from_chars_result{ first, std::errc::invalid_argument };
+            }
+            convert = &internal::convert_number<type, type>;
+        }
+        if (!convert(number, ct)) {
+            return std::from_chars_result{ symbol_end, std::errc::result_out_of_range };
+        }
+        return std::from_chars_result{ symbol_end, std::errc{} };
+    }
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "safe_types.h"
+#include "span.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAFE_TYPES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SAFE_TYPES_TARGET_SSE2
+#define SAFE_TYPES_TARGET_AVX2
+#else
+#define SAFE_TYPES_TARGET_SSE2 __attribute__((target("sse2")))
+#define SAFE_TYPES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace safe_types
+{
+    namespace internal
+    {
+        enum class simd_level
+        {
+            scalar,
+            sse2,
+            avx2
+        };
+
+        inline simd_level detect_simd_level() noexcept
+        {
+#if !defined(SAFE_TYPES_X86)
+            return simd_level::scalar;
+#elif defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            const bool avx2 = os_saves_ymm && (info[1] & (1 << 5)) != 0;
+            return avx2 ? simd_level::avx2 : sse2 ? simd_level::sse2 : simd_level::scalar;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? simd_level::avx2
+                : __builtin_cpu_supports("sse2") ? simd_level::sse2
+                : simd_level::scalar;
+#endif
+        }
+
+        inline simd_level simd_support() noexcept
+        {
+            static const simd_level level = detect_simd_level();
+            return level;
+        }
+
+        template<typename ToUT, typename RatioFrom, typename RatioTo, typename UT>
+        void convert_scalar(const UT* from, ToUT* to, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i) {
+                to[i] = cast_value<ToUT, RatioFrom, RatioTo>(from[i]);
+            }
+        }
+
+#if defined(SAFE_TYPES_X86)
+        // low 64 bits of a 64x64 product from 32x32->64 multiplies (no native 64-bit multiply before AVX-512)
+        SAFE_TYPES_TARGET_SSE2 inline __m128i mullo_epi64(__m128i a, __m128i b) noexcept
+        {
+            const __m128i low = _mm_mul_epu32(a, b);
+            const __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+            return _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+        }
+
+        SAFE_TYPES_TARGET_AVX2 inline __m256i mullo_epi64(__m256i a, __m256i b) noexcept
+        {
+            const __m256i low = _mm256_mul_epu32(a, b);
+            const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+            return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+        }
+
+        template<typename T>
+        SAFE_TYPES_TARGET_SSE2 size_t multiply_sse2(const T* from, T* to, size_t count, T factor) noexcept
+        {
+            const __m128i coef = _mm_set1_epi64x(static_cast<long long>(factor));
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), mullo_epi64(value, coef));
+            }
+            return i;
+        }
+
+        template<typename T>
+        SAFE_TYPES_TARGET_AVX2 size_t multiply_avx2(const T* from, T* to, size_t count, T factor) noexcept
+        {
+            const __m256i coef = _mm256_set1_epi64x(static_cast<long long>(factor));
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), mullo_epi64(value, coef));
+            }
+            return i;
+        }
+
+        // lanes of all ones where the signed 64-bit value is negative (no 64-bit compare before SSE4.2)
+        SAFE_TYPES_TARGET_SSE2 inline __m128i sign_epi64(__m128i value) noexcept
+        {
+            return _mm_shuffle_epi32(_mm_srai_epi32(value, 31), _MM_SHUFFLE(3, 3, 1, 1));
+        }
+
+        SAFE_TYPES_TARGET_AVX2 inline __m256i sign_epi64(__m256i value) noexcept
+        {
+            return _mm256_cmpgt_epi64(_mm256_setzero_si256(), value);
+        }
+
+        // high 64 bits of the unsigned 64x64 product, assembled from 32x32->64 multiplies as umulhi does
+        SAFE_TYPES_TARGET_SSE2 inline __m128i mulhi_epu64(__m128i a, __m128i b) noexcept
+        {
+            const __m128i low_mask = _mm_set1_epi64x(0xffffffff);
+            const __m128i a_hi = _mm_srli_epi64(a, 32);
+            const __m128i b_hi = _mm_srli_epi64(b, 32);
+            const __m128i low = _mm_mul_epu32(a, b);
+            const __m128i mid1 = _mm_add_epi64(_mm_mul_epu32(a_hi, b), _mm_srli_epi64(low, 32));
+            const __m128i mid2 = _mm_add_epi64(_mm_mul_epu32(a, b_hi), _mm_and_si128(mid1, low_mask));
+            return _mm_add_epi64(_mm_add_epi64(_mm_mul_epu32(a_hi, b_hi), _mm_srli_epi64(mid1, 32)), _mm_srli_epi64(mid2, 32));
+        }
+
+        SAFE_TYPES_TARGET_AVX2 inline __m256i mulhi_epu64(__m256i a, __m256i b) noexcept
+        {
+            const __m256i low_mask = _mm256_set1_epi64x(0xffffffff);
+            const __m256i a_hi = _mm256_srli_epi64(a, 32);
+            const __m256i b_hi = _mm256_srli_epi64(b, 32);
+            const __m256i low = _mm256_mul_epu32(a, b);
+            const __m256i mid1 = _mm256_add_epi64(_mm256_mul_epu32(a_hi, b), _mm256_srli_epi64(low, 32));
+            const __m256i mid2 = _mm256_add_epi64(_mm256_mul_epu32(a, b_hi), _mm256_and_si256(mid1, low_mask));
+            return _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a_hi, b_hi), _mm256_srli_epi64(mid1, 32)), _mm256_srli_epi64(mid2, 32));
+        }
+
+        // divide_by_reciprocal per lane: the sign corrections of the signed multiply-high and the
+        // addition of the dividend for a negative multiplier cancel, leaving umulhi(M, v) - (v < 0 ? M : 0);
+        // the arithmetic shift is emulated with a logical one (a shift of 0 moves the sign bits out by 64)
+        template<typename T>
+        SAFE_TYPES_TARGET_SSE2 size_t divide_sse2(const T* from, T* to, size_t count, reciprocal rec) noexcept
+        {
+            const __m128i multiplier = _mm_set1_epi64x(rec.multiplier);
+            const __m128i shift = _mm_cvtsi32_si128(rec.shift);
+            const __m128i sign_shift = _mm_cvtsi32_si128(64 - rec.shift);
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                __m128i quotient = _mm_sub_epi64(mulhi_epu64(multiplier, value), _mm_and_si128(sign_epi64(value), multiplier));
+                quotient = _mm_or_si128(_mm_srl_epi64(quotient, shift), _mm_sll_epi64(sign_epi64(quotient), sign_shift));
+                quotient = _mm_add_epi64(quotient, _mm_srli_epi64(value, 63));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), quotient);
+            }
+            return i;
+        }
+
+        template<typename T>
+        SAFE_TYPES_TARGET_AVX2 size_t divide_avx2(const T* from, T* to, size_t count, reciprocal rec) noexcept
+        {
+            const __m256i multiplier = _mm256_set1_epi64x(rec.multiplier);
+            const __m128i shift = _mm_cvtsi32_si128(rec.shift);
+            const __m128i sign_shift = _mm_cvtsi32_si128(64 - rec.shift);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+                __m256i quotient = _mm256_sub_epi64(mulhi_epu64(multiplier, value), _mm256_and_si256(sign_epi64(value), multiplier));
+                quotient = _mm256_or_si256(_mm256_srl_epi64(quotient, shift), _mm256_sll_epi64(sign_epi64(quotient), sign_shift));
+                quotient = _mm256_add_epi64(quotient, _mm256_srli_epi64(value, 63));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), quotient);
+            }
+            return i;
+        }
+
+        // multiply and divide are kept as separate steps to round exactly like cast_value
+        template<bool Multiply, bool Divide>
+        SAFE_TYPES_TARGET_SSE2 size_t scale_sse2(const double* from, double* to, size_t count, double num, double den) noexcept
+        {
+            const __m128d n = _mm_set1_pd(num);
+            const __m128d d = _mm_set1_pd(den);
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                __m128d value = _mm_loadu_pd(from + i);
+                value = Multiply ? _mm_mul_pd(value, n) : value;
+                value = Divide ? _mm_div_pd(value, d) : value;
+                _mm_storeu_pd(to + i, value);
+            }
+            return i;
+        }
+
+        template<bool Multiply, bool Divide>
+        SAFE_TYPES_TARGET_AVX2 size_t scale_avx2(const double* from, double* to, size_t count, double num, double den) noexcept
+        {
+            const __m256d n = _mm256_set1_pd(num);
+            const __m256d d = _mm256_set1_pd(den);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256d value = _mm256_loadu_pd(from + i);
+                value = Multiply ? _mm256_mul_pd(value, n) : value;
+                value = Divide ? _mm256_div_pd(value, d) : value;
+                _mm256_storeu_pd(to + i, value);
+            }
+            return i;
+        }
+
+        template<bool Multiply, bool Divide>
+        SAFE_TYPES_TARGET_SSE2 size_t scale_sse2(const float* from, float* to, size_t count, float num, float den) noexcept
+        {
+            const __m128 n = _mm_set1_ps(num);
+            const __m128 d = _mm_set1_ps(den);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 value = _mm_loadu_ps(from + i);
+                value = Multiply ? _mm_mul_ps(value, n) : value;
+                value = Divide ? _mm_div_ps(value, d) : value;
+                _mm_storeu_ps(to + i, value);
+            }
+            return i;
+        }
+
+        template<bool Multiply, bool Divide>
+        SAFE_TYPES_TARGET_AVX2 size_t scale_avx2(const float* from, float* to, size_t count, float num, float den) noexcept
+        {
+            const __m256 n = _mm256_set1_ps(num);
+            const __m256 d = _mm256_set1_ps(den);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 value = _mm256_loadu_ps(from + i);
+                value = Multiply ? _mm256_mul_ps(value, n) : value;
+                value = Divide ? _mm256_div_ps(value, d) : value;
+                _mm256_storeu_ps(to + i, value);
+            }
+            return i;
+        }
+#endif
+
+        template<typename T>
+        constexpr bool is_simd_integer_v = std::is_integral<T>::value && sizeof(T) == sizeof(int64_t);
+
+        template<typename T>
+        constexpr bool is_simd_floating_v = std::is_same<T, double>::value || std::is_same<T, float>::value;
+
+        // picks the kernel from the compile-time coefficient, the SIMD part handles whole vectors and
+        // the scalar loop the tail and everything the kernels do not cover: integral division by a
+        // power of two (a plain shift already), unsigned division, and num/den ratios that need
+        // multiply_divide's overflow-free split
+        template<typename ToUT, typename RatioFrom, typename RatioTo, typename UT>
+        void convert_values(const UT* from, ToUT* to, size_t count)
+        {
+            using trans_coef = std::ratio_divide<RatioFrom, RatioTo>;
+            size_t done = 0;
+            if constexpr (std::is_same<UT, ToUT>::value && trans_coef::num == 1 && trans_coef::den == 1) {
+                std::copy(from, from + count, to);
+                return;
+            }
+#if defined(SAFE_TYPES_X86)
+            if constexpr (std::is_same<UT, ToUT>::value && is_simd_integer_v<UT> && trans_coef::num != 1 && trans_coef::den == 1) {
+                const auto level = simd_support();
+                const auto num = static_cast<UT>(trans_coef::num);
+                done = level == simd_level::avx2 ? multiply_avx2(from, to, count, num)
+                    : level == simd_level::sse2 ? multiply_sse2(from, to, count, num)
+                    : 0;
+            }
+            if constexpr (std::is_same<UT, ToUT>::value && is_simd_integer_v<UT> && std::is_signed<UT>::value
+                && trans_coef::num == 1 && trans_coef::den != 1 && !is_power_of_two<trans_coef::den>) {
+                const auto level = simd_support();
+                constexpr reciprocal rec = signed_reciprocal(trans_coef::den);
+                done = level == simd_level::avx2 ? divide_avx2(from, to, count, rec)
+                    : level == simd_level::sse2 ? divide_sse2(from, to, count, rec)
+                    : 0;
+            }
+            if constexpr (std::is_same<UT, ToUT>::value && is_simd_floating_v<UT>) {
+                constexpr bool multiply = trans_coef::num != 1;
+                constexpr bool divide = trans_coef::den != 1;
+                const auto level = simd_support();
+                const auto num = static_cast<UT>(trans_coef::num);
+                const auto den = static_cast<UT>(trans_coef::den);
+                done = level == simd_level::avx2 ? scale_avx2<multiply, divide>(from, to, count, num, den)
+                    : level == simd_level::sse2 ? scale_sse2<multiply, divide>(from, to, count, num, den)
+                    : 0;
+            }
+#endif
+            convert_scalar<ToUT, RatioFrom, RatioTo>(from + done, to + done, count - done);
+        }
+    }
+
+    // converts every quantity of from into the unit of To; to must hold at least from.size() elements
+    template<typename From, typename To, typename = internal::DimIsConvertible<typename From::dimensions, typename To::dimensions>>
+    void convert(span<const From> from, span<To> to)
+    {
+        assert(to.size() >= from.size());
+        using from_und_type = typename From::underlying_type;
+        using to_und_type = typename To::underlying_type;
+        using from_period = typename From::period;
+        using to_period = typename To::period;
+        // complex_type is standard layout with a single member, so it is pointer-interconvertible with its value
+        const auto* source = reinterpret_cast<const from_und_type*>(from.data());
+        auto* target = reinterpret_cast<to_und_type*>(to.data());
+        internal::convert_values<to_und_type, from_period, to_period>(source, target, from.size());
+    }
+
+    template<typename From, typename To, typename = internal::DimIsConvertible<typename From::dimensions, typename To::dimensions>>
+    void convert(span<From> from, span<To> to)
+    {
+        convert(span<const From>{ from }, to);
+    }
+}
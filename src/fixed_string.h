@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    // string of at most N characters stored inline and padded with zeros: the object is exactly
+    // N bytes, trivially copyable, and can be memcpy-ed into binary records as is. The padding makes
+    // equality and ordering a memcmp of the whole fixed-size buffer, which compilers expand into
+    // word-sized (or vector) compares. Characters cannot be '\0', which would end the value.
+    template<size_t N>
+    class fixed_string
+    {
+        static_assert(N > 0, "fixed_string needs a positive capacity");
+
+    public:
+        constexpr fixed_string() noexcept
+            : m_data{}
+        {
+        }
+
+        // throws std::length_error when value does not fit and std::invalid_argument when it
+        // contains '\0', which size() and comparisons would take for the end of the value
+        constexpr fixed_string(std::string_view value)
+            : m_data{}
+        {
+            if (value.size() > N) {
+                throw std::length_error{ "fixed_string capacity exceeded" };
+            }
+            for (size_t i = 0; i < value.size(); ++i) {
+                if (value[i] == 0) {
+                    throw std::invalid_argument{ "fixed_string cannot hold '\\0'" };
+                }
+                m_data[i] = value[i];
+            }
+        }
+
+        constexpr fixed_string(const char* value)
+            : fixed_string{ std::string_view{ value } }
+        {
+        }
+
+        static constexpr size_t capacity() noexcept
+        {
+            return N;
+        }
+
+        size_t size() const noexcept
+        {
+            const void* end = std::memchr(m_data, 0, N);
+            return end == nullptr ? N : static_cast<size_t>(static_cast<const char*>(end) - m_data);
+        }
+
+        bool empty() const noexcept
+        {
+            return m_data[0] == 0;
+        }
+
+        constexpr const char* data() const noexcept
+        {
+            return m_data;
+        }
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view{ m_data, size() };
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        friend bool operator==(const fixed_string& first, const fixed_string& second) noexcept
+        {
+            return std::memcmp(first.m_data, second.m_data, N) == 0;
+        }
+
+        friend bool operator!=(const fixed_string& first, const fixed_string& second) noexcept
+        {
+            return !(first == second);
+        }
+
+        // zero padding sorts before every character, so this is the lexicographic order
+        friend bool operator<(const fixed_string& first, const fixed_string& second) noexcept
+        {
+            return std::memcmp(first.m_data, second.m_data, N) < 0;
+        }
+
+        template<typename Stream>
+        friend Stream& operator<<(Stream& stream, const fixed_string& value)
+        {
+            return stream << value.view();
+        }
+
+    private:
+        char m_data[N];
+    };
+
+    namespace internal
+    {
+        // hash of the whole padded buffer, one multiply-xorshift round per 8-byte word
+        template<size_t N>
+        size_t hash_words(const char* data) noexcept
+        {
+            uint64_t hash = N;
+            for (size_t offset = 0; offset < N; offset += sizeof(uint64_t)) {
+                uint64_t word = 0;
+                std::memcpy(&word, data + offset, N - offset < sizeof(uint64_t) ? N - offset : sizeof(uint64_t));
+                hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+                hash ^= hash >> 32;
+            }
+            return static_cast<size_t>(hash);
+        }
+    }
+}
+
+namespace std
+{
+    template<size_t N>
+    struct hash<safe_types::fixed_string<N>>
+    {
+        size_t operator()(const safe_types::fixed_string<N>& value) const noexcept
+        {
+            return safe_types::internal::hash_words<N>(value.data());
+        }
+    };
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "safe_types.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAFE_TYPES_FLAT_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace safe_types
+{
+    namespace internal
+    {
+        // control bytes of flat_map slots: the 7 high hash bits of a full slot, or a negative marker
+        enum class ctrl_t : int8_t
+        {
+            empty = -128,
+            deleted = -2
+        };
+
+        constexpr size_t group_width = 16;
+
+        // bit i is set for the i-th control byte of a group that matches; one compare and movemask with SSE2
+        struct group
+        {
+            const int8_t* ctrl;
+
+            uint32_t match(int8_t h2) const noexcept
+            {
+#if defined(SAFE_TYPES_FLAT_MAP_SSE2)
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < group_width; ++i) {
+                    mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+                }
+                return mask;
+#endif
+            }
+
+            uint32_t match_empty() const noexcept
+            {
+                return match(static_cast<int8_t>(ctrl_t::empty));
+            }
+
+            // empty and deleted are the negative control bytes
+            uint32_t match_free() const noexcept
+            {
+#if defined(SAFE_TYPES_FLAT_MAP_SSE2)
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < group_width; ++i) {
+                    mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+                }
+                return mask;
+#endif
+            }
+        };
+
+        inline unsigned lowest_bit(uint32_t mask) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+    }
+
+    // open-addressing hash map for complex_type keys with trivially copyable underlying values.
+    // Slots are stored inline in one array beside a control byte per slot, grouped by 16: a lookup
+    // matches the 7 spare hash bits of a whole group at once and compares keys only for those
+    // candidates, and erased slots become tombstones unless their group was never full. The hash
+    // is mixed by multiplicative_hash, so identity hashes of consecutive or strided IDs spread evenly.
+    // Iterators and references are invalidated by inserts that grow the table. Growing moves the
+    // mapped values with std::move_if_noexcept, so an insert that throws leaves the map as it was
+    // unless V is neither nothrow move constructible nor copy constructible.
+    template<typename Key, typename V, typename Hash = std::hash<Key>>
+    class flat_map
+    {
+        static_assert(internal::_is_complex_type<Key>::value, "flat_map keys are complex_type values");
+        static_assert(std::is_trivially_copyable<Key>::value, "flat_map requires trivially copyable keys");
+
+    public:
+        using key_type = Key;
+        using mapped_type = V;
+        using value_type = std::pair<const Key, V>;
+        using size_type = size_t;
+        using hasher = Hash;
+
+        template<bool Const>
+        class basic_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = flat_map::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            basic_iterator() noexcept = default;
+
+            template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+            basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+                : m_ctrl{ other.m_ctrl }
+                , m_slot{ other.m_slot }
+                , m_end{ other.m_end }
+            {
+            }
+
+            reference operator*() const noexcept
+            {
+                return *m_slot;
+            }
+
+            pointer operator->() const noexcept
+            {
+                return m_slot;
+            }
+
+            basic_iterator& operator++() noexcept
+            {
+                ++m_ctrl;
+                ++m_slot;
+                skip_free();
+                return *this;
+            }
+
+            basic_iterator operator++(int) noexcept
+            {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            friend bool operator==(const basic_iterator& first, const basic_iterator& second) noexcept
+            {
+                return first.m_ctrl == second.m_ctrl;
+            }
+
+            friend bool operator!=(const basic_iterator& first, const basic_iterator& second) noexcept
+            {
+                return first.m_ctrl != second.m_ctrl;
+            }
+
+        private:
+            friend class flat_map;
+            template<bool>
+            friend class basic_iterator;
+
+            basic_iterator(const int8_t* ctrl, pointer slot, const int8_t* end) noexcept
+                : m_ctrl{ ctrl }
+                , m_slot{ slot }
+                , m_end{ end }
+            {
+            }
+
+            void skip_free() noexcept
+            {
+                while (m_ctrl != m_end && *m_ctrl < 0) {
+                    ++m_ctrl;
+                    ++m_slot;
+                }
+            }
+
+            const int8_t* m_ctrl = nullptr;
+            pointer m_slot = nullptr;
+            const int8_t* m_end = nullptr;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        flat_map() noexcept = default;
+
+        flat_map(const flat_map& other)
+        {
+            reserve(other.size());
+            for (const auto& value : other) {
+                emplace_new(value.first, hash_of(value.first), value.second);
+            }
+        }
+
+        flat_map(flat_map&& other) noexcept
+        {
+            swap(other);
+        }
+
+        flat_map& operator=(flat_map other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~flat_map()
+        {
+            destroy();
+        }
+
+        void swap(flat_map& other) noexcept
+        {
+            std::swap(m_ctrl, other.m_ctrl);
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_free, other.m_free);
+        }
+
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return m_capacity;
+        }
+
+        iterator begin() noexcept
+        {
+            iterator it{ m_ctrl.get(), m_slots, m_ctrl.get() + m_capacity };
+            it.skip_free();
+            return it;
+        }
+
+        iterator end() noexcept
+        {
+            return iterator{ m_ctrl.get() + m_capacity, m_slots + m_capacity, m_ctrl.get() + m_capacity };
+        }
+
+        const_iterator begin() const noexcept
+        {
+            const_iterator it{ m_ctrl.get(), m_slots, m_ctrl.get() + m_capacity };
+            it.skip_free();
+            return it;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator{ m_ctrl.get() + m_capacity, m_slots + m_capacity, m_ctrl.get() + m_capacity };
+        }
+
+        iterator find(const Key& key) noexcept
+        {
+            const size_t index = find_index(key, hash_of(key));
+            return index == m_capacity ? end() : iterator_at(index);
+        }
+
+        const_iterator find(const Key& key) const noexcept
+        {
+            const size_t index = find_index(key, hash_of(key));
+            return index == m_capacity ? end() : const_iterator{ m_ctrl.get() + index, m_slots + index, m_ctrl.get() + m_capacity };
+        }
+
+        bool contains(const Key& key) const noexcept
+        {
+            return find_index(key, hash_of(key)) != m_capacity;
+        }
+
+        size_t count(const Key& key) const noexcept
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            const size_t hash = hash_of(key);
+            const size_t found = find_index(key, hash);
+            if (found != m_capacity) {
+                return { iterator_at(found), false };
+            }
+            return { iterator_at(emplace_new(key, hash, std::forward<Args>(args)...)), true };
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        V& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        size_t erase(const Key& key) noexcept
+        {
+            const size_t index = find_index(key, hash_of(key));
+            if (index == m_capacity) {
+                return 0;
+            }
+            erase_at(index);
+            return 1;
+        }
+
+        void clear() noexcept
+        {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (m_ctrl[i] >= 0) {
+                    m_slots[i].~value_type();
+                }
+            }
+            if (m_capacity != 0) {
+                std::memset(m_ctrl.get(), static_cast<int8_t>(internal::ctrl_t::empty), m_capacity);
+            }
+            m_size = 0;
+            m_free = max_load(m_capacity);
+        }
+
+        void reserve(size_t count)
+        {
+            size_t capacity = internal::group_width;
+            while (max_load(capacity) < count) {
+                capacity *= 2;
+            }
+            if (capacity > m_capacity) {
+                rehash(capacity);
+            }
+        }
+
+    private:
+        // 7/8 of the slots may be full or deleted, so every probe sequence reaches an empty slot
+        static constexpr size_t max_load(size_t capacity) noexcept
+        {
+            return capacity - capacity / 8;
+        }
+
+        static size_t hash_of(const Key& key) noexcept(noexcept(Hash{}(key)))
+        {
+            return multiplicative_hash::mix<void>(Hash{}(key));
+        }
+
+        // the top 7 bits go to the control byte, the rest select the first group
+        static int8_t h2(size_t hash) noexcept
+        {
+            return static_cast<int8_t>(hash >> (sizeof(size_t) * 8 - 7));
+        }
+
+        iterator iterator_at(size_t index) noexcept
+        {
+            return iterator{ m_ctrl.get() + index, m_slots + index, m_ctrl.get() + m_capacity };
+        }
+
+        // groups are probed in triangular steps, which visits every group of a power-of-two table
+        template<typename F>
+        size_t probe(size_t hash, F&& visit) const noexcept(noexcept(visit(size_t{})))
+        {
+            const size_t groups_mask = m_capacity / internal::group_width - 1;
+            size_t group = hash & groups_mask;
+            for (size_t step = 1;; ++step) {
+                const size_t result = visit(group * internal::group_width);
+                if (result != 0) {
+                    return result - 1;
+                }
+                group = (group + step) & groups_mask;
+            }
+        }
+
+        size_t find_index(const Key& key, size_t hash) const noexcept
+        {
+            if (m_capacity == 0) {
+                return 0;
+            }
+            const int8_t tag = h2(hash);
+            return probe(hash, [&](size_t first) noexcept -> size_t {
+                const internal::group group{ m_ctrl.get() + first };
+                for (uint32_t match = group.match(tag); match != 0; match &= match - 1) {
+                    const size_t index = first + internal::lowest_bit(match);
+                    if (m_slots[index].first == key) {
+                        return index + 1;
+                    }
+                }
+                return group.match_empty() != 0 ? m_capacity + 1 : 0;
+            });
+        }
+
+        size_t free_index(size_t hash) const noexcept
+        {
+            return probe(hash, [&](size_t first) noexcept -> size_t {
+                const uint32_t free = internal::group{ m_ctrl.get() + first }.match_free();
+                return free != 0 ? first + internal::lowest_bit(free) + 1 : 0;
+            });
+        }
+
+        template<typename... Args>
+        size_t emplace_new(const Key& key, size_t hash, Args&&... args)
+        {
+            if (m_free == 0) {
+                rehash(m_size + 1 > max_load(m_capacity) / 2 ? (m_capacity == 0 ? internal::group_width : m_capacity * 2) : m_capacity);
+            }
+            const size_t index = free_index(hash);
+            ::new (static_cast<void*>(m_slots + index)) value_type(std::piecewise_construct,
+                std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+            if (m_ctrl[index] == static_cast<int8_t>(internal::ctrl_t::empty)) {
+                --m_free;
+            }
+            m_ctrl[index] = h2(hash);
+            ++m_size;
+            return index;
+        }
+
+        // a slot of a group that still has an empty slot was never passed over by a probe,
+        // so it can become empty again instead of a tombstone
+        void erase_at(size_t index) noexcept
+        {
+            m_slots[index].~value_type();
+            --m_size;
+            const size_t first = index / internal::group_width * internal::group_width;
+            if (internal::group{ m_ctrl.get() + first }.match_empty() != 0) {
+                m_ctrl[index] = static_cast<int8_t>(internal::ctrl_t::empty);
+                ++m_free;
+            }
+            else {
+                m_ctrl[index] = static_cast<int8_t>(internal::ctrl_t::deleted);
+            }
+        }
+
+        void rehash(size_t capacity)
+        {
+            flat_map table;
+            table.m_ctrl = std::make_unique<int8_t[]>(capacity);
+            std::memset(table.m_ctrl.get(), static_cast<int8_t>(internal::ctrl_t::empty), capacity);
+            table.m_slots = std::allocator<value_type>{}.allocate(capacity);
+            table.m_capacity = capacity;
+            table.m_free = max_load(capacity);
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (m_ctrl[i] >= 0) {
+                    const size_t hash = hash_of(m_slots[i].first);
+                    const size_t index = table.free_index(hash);
+                    ::new (static_cast<void*>(table.m_slots + index)) value_type(m_slots[i].first, std::move_if_noexcept(m_slots[i].second));
+                    table.m_ctrl[index] = h2(hash);
+                    --table.m_free;
+                    ++table.m_size;
+                }
+            }
+            swap(table);
+        }
+
+        void destroy() noexcept
+        {
+            if (m_slots != nullptr) {
+                clear();
+                std::allocator<value_type>{}.deallocate(m_slots, m_capacity);
+            }
+        }
+
+        std::unique_ptr<int8_t[]> m_ctrl;
+        value_type* m_slots = nullptr;
+        size_t m_capacity = 0;
+        size_t m_size = 0;
+        // empty slots that may still be filled before the table must be rehashed
+        size_t m_free = 0;
+    };
+}
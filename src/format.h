@@ -0,0 +1,335 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "charconv.h"
+#include "safe_types.h"
+#include "unit_symbol.h"
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_format)
+#include <algorithm>
+#include <format>
+#endif
+
+namespace safe_types
+{
+    // how to_chars writes a quantity, parsed from "[.precision][a|symbol]" (the spec of std::format):
+    // no unit keeps the unit of the value, a symbol of its dimension converts to that unit, and 'a'
+    // picks the largest unit of the dimension in which the magnitude is at least 1 ("1.5KiB", "250us").
+    // Converted values are written with the given number of decimals, by default the shortest exact
+    // text for a fixed unit and at most 2 decimals when scaling automatically, after which the unit is
+    // picked. Integral values are converted exactly, rounding half to even
+    struct quantity_format
+    {
+        int precision = -1;
+        bool auto_scale = false;
+        std::string_view unit;
+    };
+
+    namespace internal
+    {
+        // a unit a value may be written in: its symbol, its ratio and the factor from the unit of the
+        // value, exactly as num/den unless that overflows (num == 0), and rounded to a double
+        struct unit_scale
+        {
+            std::string_view symbol;
+            double ratio;
+            double from_value;
+            intmax_t num;
+            intmax_t den;
+        };
+
+        template<typename CT, typename Unit>
+        constexpr unit_scale scale_of() noexcept
+        {
+            // the exact factor between two units, say miles and micrometers, may overflow
+            constexpr fraction factor = multiply(fraction{ CT::period::num, CT::period::den }, Unit::period::den, Unit::period::num);
+            constexpr double ratio = static_cast<double>(Unit::period::num) / static_cast<double>(Unit::period::den);
+            constexpr double value_ratio = static_cast<double>(CT::period::num) / static_cast<double>(CT::period::den);
+            return unit_scale{ unit_symbol_v<Unit>, ratio, value_ratio / ratio, factor.num, factor.den };
+        }
+
+        // the unit of CT first, then the units of its dimension
+        template<typename CT, typename... Units>
+        constexpr std::array<unit_scale, 1 + sizeof...(Units)> make_scales(unit_list<Units...>) noexcept
+        {
+            return std::array<unit_scale, 1 + sizeof...(Units)>{ { scale_of<CT, CT>(), scale_of<CT, Units>()... } };
+        }
+
+        template<typename CT>
+        constexpr auto unit_scales = make_scales<CT>(typename dimension_units<typename CT::dimensions>::type{});
+
+        template<typename CT>
+        constexpr const unit_scale* find_scale(std::string_view symbol) noexcept
+        {
+            for (const auto& scale : unit_scales<CT>) {
+                if (!scale.symbol.empty() && scale.symbol == symbol) {
+                    return &scale;
+                }
+            }
+            return nullptr;
+        }
+
+        // reads a quantity_format from it up to '}' or last and leaves it there; false when the spec
+        // is malformed. The unit is checked against the type of the value by the caller
+        template<typename Iterator>
+        constexpr bool parse_quantity_format(Iterator& it, Iterator last, quantity_format& format) noexcept
+        {
+            if (it != last && *it == '.') {
+                ++it;
+                if (it == last || *it < '0' || *it > '9') {
+                    return false;
+                }
+                format.precision = 0;
+                while (it != last && *it >= '0' && *it <= '9') {
+                    format.precision = format.precision * 10 + (*it - '0');
+                    if (format.precision > 100) {
+                        return false;
+                    }
+                    ++it;
+                }
+            }
+            const Iterator unit = it;
+            while (it != last && *it != '}') {
+                ++it;
+            }
+            const std::string_view text = unit == it ? std::string_view{} : std::string_view{ &*unit, static_cast<size_t>(it - unit) };
+            format.auto_scale = text == "a";
+            format.unit = format.auto_scale ? std::string_view{} : text;
+            return true;
+        }
+
+        // the value in the unit of scale, multiplying by the exact factor first so that 9ms is 0.009s
+        template<typename UT>
+        double scaled_value(const UT& value, const unit_scale& scale) noexcept
+        {
+            if (scale.num == 0) {
+                return static_cast<double>(value) * scale.from_value;
+            }
+            return static_cast<double>(value) * static_cast<double>(scale.num) / static_cast<double>(scale.den);
+        }
+
+        // the largest unit in which the magnitude, once rounded to decimals, is at least 1 ("1ms" rather
+        // than "1000us" for 999999ns at 2 decimals), otherwise the smallest unit
+        template<size_t N>
+        const unit_scale* auto_scale(const std::array<unit_scale, N>& scales, double magnitude, int decimals) noexcept
+        {
+            double half_step = 0.5;
+            for (int i = 0; i < decimals && half_step > 0; ++i) {
+                half_step /= 10;
+            }
+            const unit_scale* smallest = nullptr;
+            const unit_scale* fitting = nullptr;
+            for (const auto& candidate : scales) {
+                if (candidate.symbol.empty()) {
+                    continue;
+                }
+                if (smallest == nullptr || candidate.ratio < smallest->ratio) {
+                    smallest = &candidate;
+                }
+                if (magnitude * candidate.from_value >= 1 - half_step && (fitting == nullptr || candidate.ratio > fitting->ratio)) {
+                    fitting = &candidate;
+                }
+            }
+            return fitting != nullptr ? fitting : smallest;
+        }
+
+#if defined(__SIZEOF_INT128__)
+        constexpr int max_exact_decimals = 18;
+
+        // writes numerator/den in fixed notation, exactly: precision decimals rounded half to even, or
+        // for a negative precision all decimals when they end within max_exact_decimals. ptr is
+        // nullptr, without error, when they do not
+        inline std::to_chars_result write_quotient(char* first, char* last, __int128 numerator, intmax_t den, int precision) noexcept
+        {
+            const auto divisor = static_cast<unsigned __int128>(den);
+            unsigned __int128 integer = numerator < 0 ? 0 - static_cast<unsigned __int128>(numerator) : static_cast<unsigned __int128>(numerator);
+            unsigned __int128 rest = integer % divisor;
+            integer /= divisor;
+
+            char decimals[max_exact_decimals];
+            int decimal_count = precision;
+            if (precision < 0) {
+                for (decimal_count = 0; rest != 0 && decimal_count < max_exact_decimals; ++decimal_count) {
+                    rest *= 10;
+                    decimals[decimal_count] = static_cast<char>('0' + static_cast<int>(rest / divisor));
+                    rest %= divisor;
+                }
+                if (rest != 0) {
+                    return std::to_chars_result{ nullptr, std::errc{} };
+                }
+            }
+
+            char digits[40];
+            size_t digit_count = 0;
+            do {
+                digits[digit_count++] = static_cast<char>('0' + static_cast<int>(integer % 10));
+                integer /= 10;
+            } while (integer != 0);
+            const size_t size = (numerator < 0 ? 1 : 0) + digit_count + (decimal_count > 0 ? 1 + static_cast<size_t>(decimal_count) : 0);
+            if (static_cast<size_t>(last - first) < size) {
+                return std::to_chars_result{ last, std::errc::value_too_large };
+            }
+
+            char* out = first;
+            if (numerator < 0) {
+                *out++ = '-';
+            }
+            char* const integer_first = out;
+            while (digit_count > 0) {
+                *out++ = digits[--digit_count];
+            }
+            if (decimal_count > 0) {
+                *out++ = '.';
+            }
+            for (int i = 0; i < decimal_count; ++i) {
+                if (precision < 0) {
+                    *out++ = decimals[i];
+                }
+                else {
+                    rest *= 10;
+                    *out++ = static_cast<char>('0' + static_cast<int>(rest / divisor));
+                    rest %= divisor;
+                }
+            }
+
+            const bool odd = (out[-1] - '0') % 2 == 1;
+            if (precision >= 0 && (2 * rest > divisor || (2 * rest == divisor && odd))) {
+                char* digit = out;
+                while (digit != integer_first) {
+                    --digit;
+                    if (*digit == '.') {
+                        continue;
+                    }
+                    if (*digit != '9') {
+                        ++*digit;
+                        return std::to_chars_result{ out, std::errc{} };
+                    }
+                    *digit = '0';
+                }
+                // 9.99 rounded up to 10.00
+                if (out == last) {
+                    return std::to_chars_result{ last, std::errc::value_too_large };
+                }
+                for (char* move = out; move != integer_first; --move) {
+                    *move = move[-1];
+                }
+                *integer_first = '1';
+                ++out;
+            }
+            return std::to_chars_result{ out, std::errc{} };
+        }
+#endif
+
+        inline char* trim_zeros(char* first, char* end) noexcept
+        {
+            char* point = first;
+            while (point != end && *point != '.') {
+                ++point;
+            }
+            if (point == end) {
+                return end;
+            }
+            while (end[-1] == '0') {
+                --end;
+            }
+            return end[-1] == '.' ? end - 1 : end;
+        }
+    }
+
+    // writes the value as described by format; an unknown unit gives std::errc::invalid_argument
+    template<typename UT, typename Ratio, typename DimRatio, typename Limitations, typename = internal::to_chars_enabled<UT>>
+    std::to_chars_result to_chars(char* first, char* last, const complex_type<UT, Ratio, DimRatio, Limitations>& ct, const quantity_format& format) noexcept
+    {
+        using type = complex_type<UT, Ratio, DimRatio, Limitations>;
+        constexpr auto& scales = internal::unit_scales<type>;
+        const internal::unit_scale* scale = &scales[0];
+        if (!format.unit.empty()) {
+            scale = internal::find_scale<type>(format.unit);
+            if (scale == nullptr) {
+                return std::to_chars_result{ first, std::errc::invalid_argument };
+            }
+        }
+        if (!format.auto_scale && scale == &scales[0] && format.precision < 0) {
+            return to_chars(first, last, ct);
+        }
+        const int precision = format.precision >= 0 ? format.precision : format.auto_scale ? 2 : -1;
+        if (format.auto_scale && ct.value() != 0) {
+            const double value = static_cast<double>(ct.value());
+            const internal::unit_scale* fitting = internal::auto_scale(scales, value < 0 ? -value : value, precision);
+            scale = fitting != nullptr ? fitting : scale;
+        }
+
+        // integral values are written exactly when the factor to the unit is known exactly
+        std::to_chars_result number{ nullptr, std::errc{} };
+#if defined(__SIZEOF_INT128__)
+        if constexpr (std::is_integral<UT>::value) {
+            if (scale->num != 0) {
+                number = internal::write_quotient(first, last, static_cast<__int128>(ct.value()) * scale->num, scale->den, precision);
+            }
+        }
+#endif
+        if (number.ptr == nullptr) {
+            const double scaled = internal::scaled_value(ct.value(), *scale);
+            number = precision >= 0 ? std::to_chars(first, last, scaled, std::chars_format::fixed, precision) : std::to_chars(first, last, scaled);
+        }
+        if (number.ec == std::errc{} && format.auto_scale && format.precision < 0) {
+            number.ptr = internal::trim_zeros(first, number.ptr);
+        }
+        if (number.ec != std::errc{}) {
+            return number;
+        }
+        if (static_cast<size_t>(last - number.ptr) < scale->symbol.size()) {
+            return std::to_chars_result{ last, std::errc::value_too_large };
+        }
+        for (const char c : scale->symbol) {
+            *number.ptr++ = c;
+        }
+        return number;
+    }
+}
+
+#if defined(__cpp_lib_format)
+// std::format("{:.1a}", bytes{ 1536 }) is "1.5KiB"; the spec is that of quantity_format
+template<typename UT, typename Ratio, typename DimRatio, typename Limitations>
+    requires std::is_arithmetic_v<UT> && (!std::is_same_v<UT, bool>)
+struct std::formatter<safe_types::complex_type<UT, Ratio, DimRatio, Limitations>, char>
+{
+    using type = safe_types::complex_type<UT, Ratio, DimRatio, Limitations>;
+
+    constexpr auto parse(std::format_parse_context& context)
+    {
+        auto end = context.begin();
+        if (!safe_types::internal::parse_quantity_format(end, context.end(), m_format) ||
+            (!m_format.unit.empty() && safe_types::internal::find_scale<type>(m_format.unit) == nullptr)) {
+            throw std::format_error{ "invalid format spec for a quantity" };
+        }
+        return end;
+    }
+
+    template<typename FormatContext>
+    auto format(const type& value, FormatContext& context) const
+    {
+        char buffer[128];
+        const auto result = safe_types::to_chars(buffer, buffer + sizeof(buffer), value, m_format);
+        if (result.ec != std::errc{}) {
+            throw std::format_error{ "quantity does not fit the format buffer" };
+        }
+        return std::copy(buffer, result.ptr, context.out());
+    }
+
+private:
+    safe_types::quantity_format m_format;
+};
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    // function objects for containers of quantities; like std::less<void>, the void
+    // specializations are transparent and accept any quantities of one dimension, so
+    // containers declared with them are searched without building a converted key
+
+    template<typename T = void>
+    struct hash : std::hash<T>
+    {};
+
+    // hashes the value in base units (internal::normalized_hash), so that meters{ 1000 } and
+    // kilometers{ 1 } hash alike; that costs a modular multiply per hash for ratios other than 1,
+    // which std::hash of a quantity does not pay. Floating point quantities of different ratios
+    // compare equal up to rounding, which no hash of their values can follow, so only exact
+    // underlying types are hashed across units
+    template<>
+    struct hash<void>
+    {
+        using is_transparent = void;
+
+        template<typename UnderlyingType, typename Ratio, typename Dim, typename Lim,
+            typename = std::enable_if_t<!std::is_floating_point<UnderlyingType>::value>>
+        size_t operator()(const complex_type<UnderlyingType, Ratio, Dim, Lim>& ct) const
+            noexcept(noexcept(internal::normalized_hash<Ratio>(ct.value())))
+        {
+            return Lim::hash_policy::template mix<Dim>(internal::normalized_hash<Ratio>(ct.value()));
+        }
+    };
+
+    template<typename T = void>
+    struct equal_to : std::equal_to<T>
+    {};
+
+    template<>
+    struct equal_to<void>
+    {
+        using is_transparent = void;
+
+        template<typename T1, typename T2>
+        constexpr bool operator()(const T1& first, const T2& second) const noexcept(noexcept(first == second))
+        {
+            return first == second;
+        }
+    };
+
+    // quantity of another unit converted once to the key unit of an ordered container: keys
+    // below ceil are less than the probe and keys above floor are greater, which is exact
+    // even when the probe falls between two key values (millimeters{ 1500 } among meters)
+    template<typename Key>
+    struct probe_key
+    {
+        Key floor;
+        Key ceil;
+    };
+
+    namespace internal
+    {
+        // floor and ceil of value * Num / Den; the product is split as in multiply_divide_wide
+        template<intmax_t Num, intmax_t Den, typename T>
+        constexpr std::pair<T, T> scale_bounds(T value) noexcept
+        {
+            if constexpr (std::is_floating_point<T>::value) {
+                const T scaled = value * static_cast<T>(Num) / static_cast<T>(Den);
+                return { scaled, scaled };
+            }
+            else if constexpr (Den == 1) {
+                return { value * static_cast<T>(Num), value * static_cast<T>(Num) };
+            }
+            else {
+                static_assert(Den <= std::numeric_limits<intmax_t>::max() / Num, "the ratio between the probe and the key is too large");
+                const T quotient = divide_by<Den>(value);
+                const T part = (value - quotient * static_cast<T>(Den)) * static_cast<T>(Num);
+                const T part_quotient = divide_by<Den>(part);
+                const T remainder = part - part_quotient * static_cast<T>(Den);
+                const T truncated = quotient * static_cast<T>(Num) + part_quotient;
+                return { truncated - (remainder < 0 ? 1 : 0), truncated + (remainder > 0 ? 1 : 0) };
+            }
+        }
+    }
+
+    template<typename Key, typename UnderlyingType, typename Ratio, typename Dim, typename Lim,
+        typename = internal::DimIsConvertible<Dim, typename Key::dimensions>>
+    constexpr probe_key<Key> probe(const complex_type<UnderlyingType, Ratio, Dim, Lim>& ct) noexcept
+    {
+        using key_type = typename Key::underlying_type;
+        using coef = std::ratio_divide<Ratio, typename Key::period>;
+        using common_type = std::common_type_t<key_type, UnderlyingType, std::conditional_t<std::is_floating_point<key_type>::value, key_type, intmax_t>>;
+        const auto bounds = internal::scale_bounds<coef::num, coef::den>(static_cast<common_type>(ct.value()));
+        return probe_key<Key>{ Key{ static_cast<key_type>(bounds.first) }, Key{ static_cast<key_type>(bounds.second) } };
+    }
+
+    // std::set and std::map call the comparator for every visited node, so a quantity of another
+    // unit is scaled to the common ratio by operator< at each comparison; a probe_key built by
+    // probe<Key>() is converted once per lookup and compared in the key unit. That is the cost of
+    // looking up a key converted by hand, Key(value), which truncates: a probe buys exactness
+    // (millimeters{ 1500 } does not find meters{ 1 }), not speed over the converted key
+
+    template<typename T = void>
+    struct less : std::less<T>
+    {};
+
+    template<>
+    struct less<void>
+    {
+        using is_transparent = void;
+
+        template<typename T1, typename T2>
+        constexpr bool operator()(const T1& first, const T2& second) const noexcept(noexcept(first < second))
+        {
+            return first < second;
+        }
+
+        template<typename Key>
+        constexpr bool operator()(const Key& key, const probe_key<Key>& probe) const noexcept(noexcept(key < key))
+        {
+            return key < probe.ceil;
+        }
+
+        template<typename Key>
+        constexpr bool operator()(const probe_key<Key>& probe, const Key& key) const noexcept(noexcept(key < key))
+        {
+            return probe.floor < key;
+        }
+    };
+
+    template<typename T = void>
+    struct greater : std::greater<T>
+    {};
+
+    template<>
+    struct greater<void>
+    {
+        using is_transparent = void;
+
+        template<typename T1, typename T2>
+        constexpr bool operator()(const T1& first, const T2& second) const noexcept(noexcept(second < first))
+        {
+            return second < first;
+        }
+
+        template<typename Key>
+        constexpr bool operator()(const Key& key, const probe_key<Key>& probe) const noexcept(noexcept(key < key))
+        {
+            return probe.floor < key;
+        }
+
+        template<typename Key>
+        constexpr bool operator()(const probe_key<Key>& probe, const Key& key) const noexcept(noexcept(key < key))
+        {
+            return key < probe.ceil;
+        }
+    };
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    // std::string with its hash computed once on construction and modification, so hashing is a
+    // load and unequal strings usually compare unequal by hash alone; use it as the underlying
+    // type of a singleton (see hashed_singleton) for keys of hashed containers
+    class hashed_string
+    {
+    public:
+        hashed_string() noexcept
+            : m_value{}
+            , m_hash{ 0 }
+        {
+        }
+
+        hashed_string(std::string value)
+            : m_value{ std::move(value) }
+            , m_hash{ hash_of(m_value) }
+        {
+        }
+
+        hashed_string(const char* value)
+            : hashed_string{ std::string{ value } }
+        {
+        }
+
+        hashed_string(std::string_view value)
+            : hashed_string{ std::string{ value } }
+        {
+        }
+
+        hashed_string(const hashed_string& other) = default;
+        hashed_string& operator=(const hashed_string& other) = default;
+
+        // the moved-from string is left empty, with the hash of the empty string
+        hashed_string(hashed_string&& other) noexcept
+            : m_value{ std::move(other.m_value) }
+            , m_hash{ other.m_hash }
+        {
+            other.reset();
+        }
+
+        hashed_string& operator=(hashed_string&& other) noexcept
+        {
+            if (this != &other) {
+                m_value = std::move(other.m_value);
+                m_hash = other.m_hash;
+                other.reset();
+            }
+            return *this;
+        }
+
+        const std::string& str() const& noexcept
+        {
+            return m_value;
+        }
+
+        std::string str() && noexcept
+        {
+            std::string value = std::move(m_value);
+            reset();
+            return value;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return m_value;
+        }
+
+        size_t hash() const noexcept
+        {
+            return m_hash;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_value.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_value.empty();
+        }
+
+        hashed_string& operator+=(const hashed_string& right)
+        {
+            m_value += right.m_value;
+            m_hash = hash_of(m_value);
+            return *this;
+        }
+
+        friend bool operator==(const hashed_string& first, const hashed_string& second) noexcept
+        {
+            return first.m_hash == second.m_hash && first.m_value == second.m_value;
+        }
+
+        friend bool operator!=(const hashed_string& first, const hashed_string& second) noexcept
+        {
+            return !(first == second);
+        }
+
+        friend bool operator<(const hashed_string& first, const hashed_string& second) noexcept
+        {
+            return first.m_value < second.m_value;
+        }
+
+        friend hashed_string operator+(hashed_string first, const hashed_string& second)
+        {
+            first += second;
+            return first;
+        }
+
+        template<typename Stream>
+        friend Stream& operator<<(Stream& stream, const hashed_string& value)
+        {
+            return stream << value.m_value;
+        }
+
+    private:
+        // the empty string hashes to 0, so a moved-from value is consistent without hashing
+        static size_t hash_of(const std::string& value) noexcept
+        {
+            return value.empty() ? 0 : std::hash<std::string>{}(value);
+        }
+
+        void reset() noexcept
+        {
+            m_value.clear();
+            m_hash = 0;
+        }
+
+        std::string m_value;
+        size_t m_hash;
+    };
+
+    template<typename DimType, typename Limitations = limitations<true, true, true>>
+    using hashed_singleton = singleton<hashed_string, DimType, Limitations>;
+}
+
+namespace std
+{
+    template<>
+    struct hash<safe_types::hashed_string>
+    {
+        size_t operator()(const safe_types::hashed_string& value) const noexcept
+        {
+            return value.hash();
+        }
+    };
+}
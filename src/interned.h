@@ -0,0 +1,153 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    // process-wide set of the distinct strings of one dimension; strings are never removed,
+    // so the pointers handed out stay valid for the lifetime of the program
+    template<typename Tag>
+    class intern_table
+    {
+    public:
+        static intern_table& instance()
+        {
+            static intern_table table;
+            return table;
+        }
+
+        // the stored copy of value, added on first use; lookups of known strings take a shared lock
+        const std::string* intern(std::string_view value)
+        {
+            if (value.empty()) {
+                return &empty();
+            }
+            {
+                std::shared_lock<std::shared_mutex> lock{ m_mutex };
+                const auto found = m_index.find(value);
+                if (found != m_index.end()) {
+                    return found->second;
+                }
+            }
+            std::unique_lock<std::shared_mutex> lock{ m_mutex };
+            const auto found = m_index.find(value);
+            if (found != m_index.end()) {
+                return found->second;
+            }
+            const std::string* stored = &m_strings.emplace_back(value);
+            m_index.emplace(*stored, stored);
+            return stored;
+        }
+
+        size_t size() const
+        {
+            std::shared_lock<std::shared_mutex> lock{ m_mutex };
+            return m_strings.size();
+        }
+
+        static const std::string& empty() noexcept
+        {
+            static const std::string value;
+            return value;
+        }
+
+    private:
+        intern_table() = default;
+
+        mutable std::shared_mutex m_mutex;
+        // deque keeps the addresses of the stored strings on growth; the index views them
+        std::deque<std::string> m_strings;
+        std::unordered_map<std::string_view, const std::string*> m_index;
+    };
+
+    // pointer to the single stored copy of a string in the intern table of Tag: copying, comparing
+    // for equality and hashing are pointer operations, and repeated values share one allocation;
+    // ordering compares the characters, so ordered containers keep the lexicographic order
+    template<typename Tag>
+    class interned_string
+    {
+    public:
+        interned_string() noexcept
+            : m_value{ &intern_table<Tag>::empty() }
+        {
+        }
+
+        interned_string(std::string_view value)
+            : m_value{ intern_table<Tag>::instance().intern(value) }
+        {
+        }
+
+        interned_string(const char* value)
+            : interned_string{ std::string_view{ value } }
+        {
+        }
+
+        interned_string(const std::string& value)
+            : interned_string{ std::string_view{ value } }
+        {
+        }
+
+        const std::string& str() const noexcept
+        {
+            return *m_value;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return *m_value;
+        }
+
+        const std::string* get() const noexcept
+        {
+            return m_value;
+        }
+
+        friend bool operator==(const interned_string& first, const interned_string& second) noexcept
+        {
+            return first.m_value == second.m_value;
+        }
+
+        friend bool operator!=(const interned_string& first, const interned_string& second) noexcept
+        {
+            return first.m_value != second.m_value;
+        }
+
+        friend bool operator<(const interned_string& first, const interned_string& second) noexcept
+        {
+            return first.m_value != second.m_value && *first.m_value < *second.m_value;
+        }
+
+        template<typename Stream>
+        friend Stream& operator<<(Stream& stream, const interned_string& value)
+        {
+            return stream << *value.m_value;
+        }
+
+    private:
+        const std::string* m_value;
+    };
+
+    // arithmetic is disabled: concatenation would intern every intermediate result
+    template<typename DimType, typename Limitations = limitations<false, true, true>>
+    using interned = singleton<interned_string<DimType>, DimType, Limitations>;
+}
+
+namespace std
+{
+    template<typename Tag>
+    struct hash<safe_types::interned_string<Tag>>
+    {
+        size_t operator()(const safe_types::interned_string<Tag>& value) const noexcept
+        {
+            return std::hash<const std::string*>{}(value.get());
+        }
+    };
+}
@@ -1,10 +1,31 @@
 #define CATCH_CONFIG_MAIN
 #include "catch2/catch.hpp"
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "arena.h"
+#include "charconv.h"
+#include "convert.h"
+#include "fixed_string.h"
+#include "flat_map.h"
+#include "format.h"
+#include "functional.h"
+#include "hashed_string.h"
+#include "interned.h"
 #include "physical_types.h"
+#include "quantity_vector.h"
+#include "serialize.h"
+#include "slot_map.h"
+#include "typed_vector.h"
 
 TEST_CASE("test singleton equality", "[singleton]")
 {
@@ -38,6 +59,35 @@ TEST_CASE("test simple sum", "[simple]")
     REQUIRE(safe_types::kilometers{ 2 } == safe_types::meters{ 1000 } +safe_types::kilometers{ 1 });
 }
 
+TEST_CASE("test simple difference", "[simple]")
+{
+    REQUIRE(safe_types::kilometers{ 2 } - safe_types::meters{ 500 } == safe_types::meters{ 1500 });
+    REQUIRE(safe_types::meters{ 500 } - safe_types::kilometers{ 1 } == safe_types::meters{ -500 });
+}
+
+TEST_CASE("test rvalue operators", "[simple]")
+{
+    auto distance = safe_types::meters{ 10 };
+    REQUIRE(std::move(distance) + safe_types::meters{ 5 } == safe_types::meters{ 15 });
+    REQUIRE(safe_types::meters{ 10 } - safe_types::meters{ 15 } == safe_types::meters{ -5 });
+    REQUIRE(safe_types::meters{ 1010 } % safe_types::meters{ 1000 } == safe_types::meters{ 10 });
+    REQUIRE(safe_types::meters{ 10 } * 3 == safe_types::meters{ 30 });
+    REQUIRE(safe_types::meters{ 30 } / 3 == safe_types::meters{ 10 });
+    REQUIRE(safe_types::meters{ 31 } % 3 == safe_types::meters{ 1 });
+}
+
+TEST_CASE("test rvalue sum reuses storage", "[singleton]")
+{
+    class SomeStringDim;
+    using SomeString = safe_types::singleton<std::string, SomeStringDim>;
+    std::string buffer = "left";
+    buffer.reserve(64);
+    const auto* const data = buffer.data();
+    auto sum = SomeString{ std::move(buffer) } + SomeString{ " right" };
+    REQUIRE(sum.value() == "left right");
+    REQUIRE(sum.value().data() == data);
+}
+
 TEST_CASE("test comlex multiply", "[complex]")
 {
     safe_types::meters d1{ 1000 };
@@ -93,6 +143,135 @@ TEST_CASE("test complex in unordered set", "[complex]")
     REQUIRE(meters.find(safe_types::meters{ 3 }) == meters.end());
 }
 
+TEST_CASE("test normalized hash", "[complex]")
+{
+    using namespace safe_types;
+    const safe_types::hash<> hasher;
+    REQUIRE(hasher(meters{ 1000 }) == hasher(kilometers{ 1 }));
+    REQUIRE(hasher(meters{ -3000 }) == hasher(kilometers{ -3 }));
+    REQUIRE(hasher(millimeters{ 0 }) == hasher(kilometers{ 0 }));
+    REQUIRE(hasher(micrometers{ 1500 }) == hasher(millimeters{ 1 } + micrometers{ 500 }));
+    REQUIRE(hasher(inches{ 196847 }) == hasher(meters{ 5000 }));
+    REQUIRE(hasher(seconds{ 120 }) == hasher(minutes{ 2 }));
+    REQUIRE(hasher(millimeters{ 1 }) != hasher(millimeters{ 2 }));
+    REQUIRE(std::hash<meters>{}(meters{ 42 }) == std::hash<long long>{}(42));
+    REQUIRE(std::hash<millimeters>{}(millimeters{ 42 }) == std::hash<long long>{}(42));
+    REQUIRE(hasher(meters{ 42 }) == std::hash<meters>{}(meters{ 42 }));
+
+    const safe_types::equal_to<> equal;
+    REQUIRE(equal(meters{ 1000 }, kilometers{ 1 }));
+    REQUIRE(!equal(meters{ 999 }, kilometers{ 1 }));
+
+    std::unordered_set<meters, safe_types::hash<>, safe_types::equal_to<>> distances;
+    distances.insert(meters{ 1000 });
+    distances.insert(kilometers{ 2 });
+    REQUIRE(distances.find(meters{ 2000 }) != distances.end());
+#if defined(__cpp_lib_generic_unordered_lookup)
+    REQUIRE(distances.find(kilometers{ 1 }) != distances.end());
+    REQUIRE(distances.find(millimeters{ 1 }) == distances.end());
+#endif
+}
+
+TEST_CASE("test transparent hash and equality agree", "[complex]")
+{
+    using namespace safe_types;
+    static_assert(std::is_same<safe_types::hash<>::is_transparent, void>::value && std::is_same<safe_types::equal_to<>::is_transparent, void>::value,
+        "the void specializations are transparent");
+    using real_meters = simple_type<double, std::ratio<1>, DistanceDim>;
+    static_assert(!std::is_invocable<safe_types::hash<>, const real_meters&>::value, "floating quantities are not hashed across units");
+    static_assert(std::is_invocable<safe_types::hash<>, const kilometers&>::value, "integral quantities are hashed across units");
+
+    // what a heterogeneous find relies on: keys equal across units hash alike
+    const safe_types::hash<> hasher;
+    const safe_types::equal_to<> equal;
+    for (long long value = -2000; value <= 2000; value += 125) {
+        const millimeters fine{ value * 1000 };
+        const meters middle{ value };
+        REQUIRE(equal(fine, middle));
+        REQUIRE(hasher(fine) == hasher(middle));
+        if (value % 1000 == 0) {
+            const kilometers coarse{ value / 1000 };
+            REQUIRE(equal(middle, coarse));
+            REQUIRE(hasher(middle) == hasher(coarse));
+        }
+        REQUIRE(!equal(fine, millimeters{ value * 1000 + 1 }));
+    }
+}
+
+TEST_CASE("test transparent ordering", "[complex]")
+{
+    using namespace safe_types;
+    std::set<meters, safe_types::less<>> ascending{ meters{ 1 }, meters{ 2 }, meters{ 1000 } };
+    REQUIRE(ascending.find(kilometers{ 1 }) != ascending.end());
+    REQUIRE(ascending.find(millimeters{ 2000 }) != ascending.end());
+    REQUIRE(ascending.find(millimeters{ 1500 }) == ascending.end());
+    REQUIRE(ascending.count(millimeters{ 1000 }) == 1);
+    REQUIRE(*ascending.lower_bound(millimeters{ 1500 }) == meters{ 2 });
+    REQUIRE(*ascending.upper_bound(millimeters{ 1000 }) == meters{ 2 });
+
+    std::set<meters, safe_types::greater<>> descending{ meters{ 1 }, meters{ 2 }, meters{ 1000 } };
+    REQUIRE(*descending.begin() == kilometers{ 1 });
+    REQUIRE(descending.find(kilometers{ 1 }) != descending.end());
+    REQUIRE(*descending.lower_bound(millimeters{ 1500 }) == meters{ 1 });
+
+    REQUIRE(ascending.find(probe<meters>(kilometers{ 1 })) != ascending.end());
+    REQUIRE(ascending.find(probe<meters>(millimeters{ 2000 })) != ascending.end());
+    REQUIRE(ascending.find(probe<meters>(millimeters{ 1500 })) == ascending.end());
+    REQUIRE(ascending.find(probe<meters>(millimeters{ -1500 })) == ascending.end());
+    REQUIRE(*ascending.lower_bound(probe<meters>(millimeters{ 1500 })) == meters{ 2 });
+    REQUIRE(*ascending.upper_bound(probe<meters>(millimeters{ 1000 })) == meters{ 2 });
+    REQUIRE(*ascending.lower_bound(probe<meters>(inches{ 39 })) == meters{ 1 });
+    REQUIRE(*ascending.lower_bound(probe<meters>(inches{ 40 })) == meters{ 2 });
+    REQUIRE(*descending.lower_bound(probe<meters>(millimeters{ 1500 })) == meters{ 1 });
+    REQUIRE(*descending.upper_bound(probe<meters>(millimeters{ 2000 })) == meters{ 1 });
+
+    constexpr auto bounds = probe<meters>(millimeters{ -1500 });
+    static_assert(bounds.floor == meters{ -2 } && bounds.ceil == meters{ -1 }, "probe should round outwards");
+    static_assert(safe_types::less<>{}(millimeters{ 999 }, meters{ 1 }), "less should compare across ratios");
+    static_assert(safe_types::greater<meters>{}(meters{ 2 }, meters{ 1 }), "typed greater should follow std::greater");
+}
+
+template<typename Key>
+size_t used_buckets(size_t stride)
+{
+    std::unordered_set<size_t> buckets;
+    for (uint64_t i = 0; i < 1024; ++i) {
+        buckets.insert(std::hash<Key>{}(Key{ i * stride }) & 1023);
+    }
+    return buckets.size();
+}
+
+TEST_CASE("test hash policies", "[singleton]")
+{
+    using namespace safe_types;
+    class UserIdDim;
+    class OrderIdDim;
+    using identity_id = singleton<uint64_t, UserIdDim>;
+    using multiplicative_id = singleton<uint64_t, UserIdDim, limitations<true, true, true, multiplicative_hash>>;
+    using wy_id = singleton<uint64_t, UserIdDim, limitations<true, true, true, wy_hash>>;
+    using user_id = singleton<uint64_t, UserIdDim, limitations<true, true, true, salted_hash<>>>;
+    using order_id = singleton<uint64_t, OrderIdDim, limitations<true, true, true, salted_hash<>>>;
+
+    REQUIRE(std::hash<identity_id>{}(identity_id{ 42 }) == std::hash<uint64_t>{}(42));
+    REQUIRE(used_buckets<identity_id>(4096) == 1);
+    REQUIRE(used_buckets<multiplicative_id>(4096) > 512);
+    REQUIRE(used_buckets<wy_id>(4096) > 512);
+    REQUIRE(used_buckets<user_id>(4096) > 512);
+    REQUIRE(std::hash<user_id>{}(user_id{ 42 }) != std::hash<order_id>{}(order_id{ 42 }));
+    REQUIRE(std::hash<user_id>{}(user_id{ 42 }) == std::hash<user_id>{}(user_id{ 42 }));
+
+    using salted_limitations = limitations<true, true, true, salted_hash<multiplicative_hash>>;
+    using salted_meters = simple_type<long long, std::ratio<1>, DistanceDim, salted_limitations>;
+    using salted_kilometers = simple_type<long long, std::kilo, DistanceDim, salted_limitations>;
+    REQUIRE(safe_types::hash<>{}(salted_meters{ 1000 }) == safe_types::hash<>{}(salted_kilometers{ 1 }));
+    REQUIRE(safe_types::hash<>{}(salted_meters{ 1000 }) == std::hash<salted_meters>{}(salted_meters{ 1000 }));
+    REQUIRE(salted_meters{ 1000 } == salted_kilometers{ 1 });
+
+    std::unordered_set<user_id> users{ user_id{ 1 }, user_id{ 4096 } };
+    REQUIRE(users.count(user_id{ 4096 }) == 1);
+    REQUIRE(users.count(user_id{ 2 }) == 0);
+}
+
 TEST_CASE("test strings", "[singleton]")
 {
     class SomeStringDim;
@@ -105,14 +284,678 @@ TEST_CASE("test strings", "[singleton]")
     REQUIRE(strings.find(SomeString{ "1" }) == strings.end());
 }
 
-TEST_CASE("test internal::trim", "[complex]")
+TEST_CASE("test hashed strings", "[singleton]")
+{
+    class RouteDim;
+    using Route = safe_types::hashed_singleton<RouteDim>;
+    const Route route{ "/api/v1/users" };
+    REQUIRE(route.value().hash() == std::hash<std::string>{}("/api/v1/users"));
+    REQUIRE(std::hash<Route>{}(route) == std::hash<Route>{}(Route{ std::string{ "/api/v1/users" } }));
+    REQUIRE(route == Route{ "/api/v1/users" });
+    REQUIRE(route != Route{ "/api/v1/orders" });
+    REQUIRE(Route{ "/a" } < Route{ "/b" });
+    static_assert(std::is_nothrow_move_constructible<Route>::value, "hashed singleton should be nothrow movable");
+
+    std::unordered_set<Route> routes{ route, Route{ "/api/v1/orders" } };
+    REQUIRE(routes.find(Route{ "/api/v1/orders" }) != routes.end());
+    REQUIRE(routes.find(Route{ "/api/v2/orders" }) == routes.end());
+
+    auto moved = Route{ "/moved" };
+    const auto target = std::move(moved);
+    REQUIRE(moved == Route{ "" });
+    REQUIRE(std::hash<Route>{}(moved) == std::hash<Route>{}(Route{}));
+    safe_types::hashed_string kept{ "/kept" };
+    safe_types::hashed_string& alias = kept;
+    kept = std::move(alias);
+    REQUIRE(kept.str() == "/kept");
+    REQUIRE(kept.hash() == std::hash<std::string>{}("/kept"));
+
+    const auto joined = Route{ "/api" } + Route{ "/v1" };
+    REQUIRE(joined == Route{ "/api/v1" });
+    REQUIRE(joined.value().hash() == std::hash<std::string>{}("/api/v1"));
+}
+
+TEST_CASE("test interned strings", "[singleton]")
+{
+    class TenantDim;
+    using Tenant = safe_types::interned<TenantDim>;
+    const auto tables_before = safe_types::intern_table<TenantDim>::instance().size();
+    const Tenant acme{ "acme" };
+    const Tenant copy{ std::string{ "acme" } };
+    REQUIRE(acme == copy);
+    REQUIRE(acme.value().get() == copy.value().get());
+    REQUIRE(acme != Tenant{ "globex" });
+    REQUIRE(!(Tenant{ "globex" } < acme));
+    REQUIRE(acme < Tenant{ "globex" });
+    REQUIRE(Tenant{} == Tenant{ "" });
+    REQUIRE(acme.value().str() == "acme");
+    REQUIRE(std::hash<Tenant>{}(acme) == std::hash<Tenant>{}(copy));
+    REQUIRE(safe_types::intern_table<TenantDim>::instance().size() == tables_before + 2);
+    static_assert(sizeof(Tenant) == sizeof(void*) && std::is_trivially_copyable<Tenant>::value, "interned value should be a pointer");
+
+    class OtherDim;
+    using Other = safe_types::interned<OtherDim>;
+    REQUIRE(static_cast<const void*>(Other{ "acme" }.value().get()) != static_cast<const void*>(acme.value().get()));
+
+    std::vector<const std::string*> pointers(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        threads.emplace_back([&pointers, i]() {
+            for (int j = 0; j < 1000; ++j) {
+                Tenant{ "tenant-" + std::to_string(j) };
+            }
+            pointers[i] = Tenant{ "tenant-500" }.value().get();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto* pointer : pointers) {
+        REQUIRE(pointer == pointers.front());
+    }
+    REQUIRE(safe_types::intern_table<TenantDim>::instance().size() == tables_before + 2 + 1000);
+}
+
+TEST_CASE("test fixed strings", "[singleton]")
+{
+    class TickerDim;
+    using Ticker = safe_types::singleton<safe_types::fixed_string<12>, TickerDim>;
+    static_assert(std::is_trivially_copyable<Ticker>::value && sizeof(Ticker) == 12, "fixed string singleton should be its inline buffer");
+
+    const Ticker msft{ "MSFT" };
+    REQUIRE(msft.value().size() == 4);
+    REQUIRE(msft.value().view() == "MSFT");
+    REQUIRE(msft == Ticker{ "MSFT" });
+    REQUIRE(msft != Ticker{ "MSFT.O" });
+    REQUIRE(Ticker{ "MSF" } < msft);
+    REQUIRE(msft < Ticker{ "MSFT.O" });
+    REQUIRE(msft < Ticker{ "MSFU" });
+    REQUIRE(Ticker{ "ABCDEFGHIJKL" }.value().size() == 12);
+    REQUIRE(Ticker{}.value().empty());
+    REQUIRE_THROWS_AS(Ticker{ "ABCDEFGHIJKLM" }, std::length_error);
+    REQUIRE_THROWS_AS(safe_types::fixed_string<12>{ std::string_view("MS\0FT", 5) }, std::invalid_argument);
+    REQUIRE_THROWS_AS(safe_types::fixed_string<12>{ std::string_view("MSFT\0", 5) }, std::invalid_argument);
+
+    char record[2 * sizeof(Ticker)];
+    const Ticker tickers[] = { msft, Ticker{ "AAPL" } };
+    std::memcpy(record, tickers, sizeof(record));
+    Ticker restored[2];
+    std::memcpy(restored, record, sizeof(record));
+    REQUIRE(restored[1] == Ticker{ "AAPL" });
+    REQUIRE(std::string(record + sizeof(Ticker)) == "AAPL");
+
+    std::unordered_set<Ticker> symbols{ msft, Ticker{ "AAPL" } };
+    REQUIRE(symbols.count(Ticker{ "AAPL" }) == 1);
+    REQUIRE(symbols.count(Ticker{ "GOOG" }) == 0);
+    REQUIRE(std::hash<Ticker>{}(msft) != std::hash<Ticker>{}(Ticker{ "MSFU" }));
+}
+
+TEST_CASE("test arena strings", "[singleton]")
+{
+    class MethodDim;
+    class PathDim;
+    using Method = safe_types::arena_singleton<MethodDim>;
+    using Path = safe_types::arena_singleton<PathDim>;
+
+    safe_types::string_arena arena{ 16 };
+    const std::string_view request = "GET /index.html";
+    char* buffer = arena.allocate(request.size());
+    std::memcpy(buffer, request.data(), request.size());
+    const std::string_view text{ buffer, request.size() };
+    const Method method{ arena.view(text.substr(0, 3)) };
+    const Path path{ arena.view(text.substr(4)) };
+    REQUIRE(method.value().view() == "GET");
+    REQUIRE(method.value().data() == buffer);
+    REQUIRE(path.value().view() == "/index.html");
+    REQUIRE(arena.owns(path.value()));
+    REQUIRE(!arena.owns(request));
+
+    const Path stored{ arena.store("/a/path/longer/than/the/block") };
+    REQUIRE(stored.value().view() == "/a/path/longer/than/the/block");
+    REQUIRE(path.value().view() == "/index.html");
+    REQUIRE(arena.bytes_used() == request.size() + stored.value().size());
+    REQUIRE(Path{ arena.store("/index.html") } == path);
+    REQUIRE(stored < path);
+    REQUIRE(std::hash<Path>{}(path) == std::hash<std::string_view>{}("/index.html"));
+    static_assert(std::is_trivially_copyable<Path>::value && sizeof(Path) == sizeof(std::string_view) + sizeof(uint64_t),
+        "arena view should be a string_view and an epoch in every build");
+#if !defined(NDEBUG)
+    const Path copy{ path };
+    REQUIRE(copy.value().valid());
+    arena.reset();
+    REQUIRE(!copy.value().valid());
+    REQUIRE(arena.bytes_used() == 0);
+    REQUIRE(arena.store("/again").valid());
+    safe_types::arena_view orphan;
+    {
+        safe_types::string_arena scoped;
+        orphan = scoped.store("/scoped");
+        REQUIRE(orphan.valid());
+    }
+    REQUIRE(!orphan.valid());
+    REQUIRE(safe_types::arena_view{}.valid());
+    // more arenas than epoch slots: the extra ones go unchecked, the others keep their checks
+    std::vector<std::unique_ptr<safe_types::string_arena>> arenas;
+    for (size_t i = 0; i < 5000; ++i) {
+        arenas.push_back(std::make_unique<safe_types::string_arena>());
+    }
+    const auto checked = arenas.front()->store("/checked");
+    arenas.front()->reset();
+    REQUIRE(!checked.valid());
+    const auto unchecked = arenas.back()->store("/unchecked");
+    arenas.back()->reset();
+    REQUIRE(unchecked.valid());
+#endif
+    static_assert(noexcept(arena.reset()), "reset should not throw");
+}
+
+TEST_CASE("test flat_map", "[flat_map]")
+{
+    class UserIdDim;
+    using UserId = safe_types::singleton<long long, UserIdDim>;
+    safe_types::flat_map<UserId, std::string> names;
+    REQUIRE(names.find(UserId{ 1 }) == names.end());
+    REQUIRE(names.try_emplace(UserId{ 1 }, "one").second);
+    REQUIRE(!names.try_emplace(UserId{ 1 }, "uno").second);
+    names[UserId{ 2 }] = "two";
+    REQUIRE(names.size() == 2);
+    REQUIRE(names.find(UserId{ 1 })->second == "one");
+    REQUIRE(names[UserId{ 2 }] == "two");
+    REQUIRE(names.erase(UserId{ 1 }) == 1);
+    REQUIRE(names.erase(UserId{ 1 }) == 0);
+    REQUIRE(!names.contains(UserId{ 1 }));
+
+    const auto copy = names;
+    REQUIRE(copy.count(UserId{ 2 }) == 1);
+    size_t visited = 0;
+    for (const auto& entry : copy) {
+        REQUIRE(entry.first == UserId{ 2 });
+        ++visited;
+    }
+    REQUIRE(visited == 1);
+
+    // random operations against std::unordered_map, with strided keys and enough erases for tombstones
+    safe_types::flat_map<UserId, long long> map;
+    std::unordered_map<long long, long long> reference;
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < 200000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const long long key = static_cast<long long>(state % 5000) * 4096;
+        if (state % 3 == 0) {
+            REQUIRE(map.erase(UserId{ key }) == reference.erase(key));
+        }
+        else {
+            map[UserId{ key }] += i;
+            reference[key] += i;
+        }
+    }
+    REQUIRE(map.size() == reference.size());
+    for (const auto& entry : reference) {
+        const auto found = map.find(UserId{ entry.first });
+        REQUIRE(found != map.end());
+        REQUIRE(found->second == entry.second);
+    }
+    size_t entries = 0;
+    for (const auto& entry : map) {
+        REQUIRE(reference.at(entry.first.value()) == entry.second);
+        ++entries;
+    }
+    REQUIRE(entries == reference.size());
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+}
+
+// a mapped value whose move may throw, so flat_map has to copy it when growing
+struct throwing_copy
+{
+    static int copies_left;
+
+    explicit throwing_copy(int value) : value{ value } {}
+
+    throwing_copy(const throwing_copy& other) : value{ other.value }
+    {
+        if (copies_left-- == 0) {
+            throw std::runtime_error{ "copy failed" };
+        }
+    }
+
+    throwing_copy(throwing_copy&& other) : value{ other.value }
+    {
+        other.value = -1;
+    }
+
+    int value;
+};
+
+int throwing_copy::copies_left = 0;
+
+TEST_CASE("test flat_map growth keeps values when a copy throws", "[flat_map]")
+{
+    class UserIdDim;
+    using UserId = safe_types::singleton<long long, UserIdDim>;
+    safe_types::flat_map<UserId, throwing_copy> map;
+    throwing_copy::copies_left = 1000;
+    int count = 0;
+    for (; map.capacity() == 0 || map.size() < map.capacity() - map.capacity() / 8; ++count) {
+        map.try_emplace(UserId{ count }, count);
+    }
+    const size_t capacity = map.capacity();
+    throwing_copy::copies_left = 3;
+    REQUIRE_THROWS_AS(map.try_emplace(UserId{ count }, count), std::runtime_error);
+    REQUIRE(map.capacity() == capacity);
+    REQUIRE(map.size() == static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(map.find(UserId{ i })->second.value == i);
+    }
+    throwing_copy::copies_left = 1000;
+    REQUIRE(map.try_emplace(UserId{ count }, count).second);
+    REQUIRE(map.find(UserId{ 0 })->second.value == 0);
+}
+
+TEST_CASE("test typed_vector", "[typed_vector]")
+{
+    class NodeIdDim;
+    class EdgeIdDim;
+    using NodeId = safe_types::singleton<uint32_t, NodeIdDim>;
+    using EdgeId = safe_types::singleton<uint32_t, EdgeIdDim>;
+    static_assert(!std::is_convertible<EdgeId, NodeId>::value, "IDs of different dimensions do not mix");
+
+    safe_types::typed_vector<NodeId, std::string> nodes;
+    REQUIRE(nodes.next_id() == NodeId{ 0 });
+    const NodeId first = nodes.push_back("first");
+    const NodeId second = nodes.emplace_back(3, 'x');
+    REQUIRE(first == NodeId{ 0 });
+    REQUIRE(second == NodeId{ 1 });
+    REQUIRE(nodes[first] == "first");
+    REQUIRE(nodes[second] == "xxx");
+    REQUIRE(nodes.contains(second));
+    REQUIRE(!nodes.contains(NodeId{ 2 }));
+    REQUIRE_THROWS_AS(nodes.at(NodeId{ 2 }), std::out_of_range);
+    nodes[first] = "changed";
+    REQUIRE(nodes.at(first) == "changed");
+    REQUIRE(nodes.values().size() == 2);
+
+    safe_types::typed_vector<EdgeId, NodeId> targets(2, second);
+    REQUIRE(nodes[targets[EdgeId{ 1 }]] == "xxx");
+}
+
+TEST_CASE("test slot_map", "[slot_map]")
+{
+    class HandleDim;
+    using Handle = safe_types::singleton<uint32_t, HandleDim>;
+    safe_types::slot_map<Handle, std::string> map;
+    const auto first = map.insert("first");
+    const auto second = map.emplace(2, 'b');
+    REQUIRE(map.size() == 2);
+    REQUIRE(map[first] == "first");
+    REQUIRE(*map.find(second) == "bb");
+
+    REQUIRE(map.erase(first));
+    REQUIRE(!map.erase(first));
+    REQUIRE(!map.contains(first));
+    REQUIRE(map.find(first) == nullptr);
+    REQUIRE_THROWS_AS(map.at(first), std::out_of_range);
+    REQUIRE(map[second] == "bb");
+
+    // the freed slot is reused with a new generation, so the stale key still misses
+    const auto third = map.insert("third");
+    REQUIRE(third.index == first.index);
+    REQUIRE(third != first);
+    REQUIRE(!map.contains(first));
+    REQUIRE(map.at(third) == "third");
+
+    std::set<std::string> values(map.begin(), map.end());
+    REQUIRE(values == std::set<std::string>{ "bb", "third" });
+    for (size_t i = 0; i < map.size(); ++i) {
+        REQUIRE(map[map.key_at(i)] == map.values()[i]);
+    }
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(!map.contains(second));
+    REQUIRE(!map.contains(third));
+
+    // random inserts and erases against std::unordered_map
+    safe_types::slot_map<Handle, int> numbers;
+    std::unordered_map<safe_types::generational_id<Handle>, int> reference;
+    std::vector<safe_types::generational_id<Handle>> keys;
+    unsigned state = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1103515245u + 12345u;
+        if (!keys.empty() && (state >> 16) % 3 == 0) {
+            const size_t pick = (state >> 4) % keys.size();
+            REQUIRE(numbers.erase(keys[pick]) == (reference.erase(keys[pick]) == 1));
+        }
+        else {
+            const auto key = numbers.insert(i);
+            REQUIRE(reference.emplace(key, i).second);
+            keys.push_back(key);
+        }
+    }
+    REQUIRE(numbers.size() == reference.size());
+    for (const auto& key : keys) {
+        const auto found = reference.find(key);
+        REQUIRE(numbers.contains(key) == (found != reference.end()));
+        if (found != reference.end()) {
+            REQUIRE(numbers[key] == found->second);
+        }
+    }
+}
+
+using knots = decltype(safe_types::nautical_miles{} / safe_types::hours{});
+
+namespace safe_types
+{
+    template<> struct unit_symbol<knots::period::type, knots::dimensions> { static constexpr std::string_view value{ "kn" }; };
+}
+
+TEST_CASE("test unit_symbol", "[unit_symbol]")
 {
-    using type1 = safe_types::internal::tuple_dim<safe_types::DistanceDim, safe_types::DurationDim>;
-    using sametype = safe_types::internal::tuple_dim<safe_types::DurationDim, safe_types::DistanceDim>;
-    using type2 = safe_types::internal::tuple_dim<safe_types::DurationDim>;
-    REQUIRE(std::is_same<safe_types::internal::trim<type1, type1>::num, safe_types::internal::tuple_dim<>>::value == true);
-    REQUIRE(std::is_same<safe_types::internal::trim<type1, sametype>::num, safe_types::internal::tuple_dim<>>::value == true);
-    REQUIRE(std::is_same<safe_types::internal::trim<type1, type2>::num, safe_types::internal::tuple_dim<>>::value == false);
+    using safe_types::unit_symbol_v;
+    static_assert(unit_symbol_v<safe_types::milliseconds> == "ms", "aliases name themselves");
+    static_assert(unit_symbol_v<safe_types::gigabytes> == "GiB", "aliases name themselves");
+    static_assert(unit_symbol_v<decltype(safe_types::kilometers{} / safe_types::hours{})> == "km/h", "quotients are synthesized");
+    static_assert(unit_symbol_v<decltype(safe_types::millimeters{} / (safe_types::seconds{} * safe_types::seconds{}))> == "mm/s^2", "powers are synthesized");
+    static_assert(unit_symbol_v<decltype(safe_types::meters{} * safe_types::meters{})> == "m^2", "powers are synthesized");
+    static_assert(unit_symbol_v<decltype(safe_types::megabytes{} / safe_types::milliseconds{})> == "MiB/ms", "quotients are synthesized");
+    // the order of factors is the canonical order of the dimension tags
+    static_assert(unit_symbol_v<decltype(safe_types::seconds{} / (safe_types::meters{} * safe_types::grams{}))> == "s/(m*g)" ||
+        unit_symbol_v<decltype(safe_types::seconds{} / (safe_types::meters{} * safe_types::grams{}))> == "s/(g*m)", "several denominators are grouped");
+    static_assert(unit_symbol_v<safe_types::simple_type<long long, std::nano, safe_types::DistanceDim>> == "nm", "SI prefixes apply to units of ratio 1");
+    static_assert(unit_symbol_v<safe_types::simple_type<double, std::ratio<7>, safe_types::DurationDim>>.empty(), "unnamed ratios have no symbol");
+    static_assert(unit_symbol_v<knots> == "kn", "specializations override the synthesized name");
+    static_assert(unit_symbol_v<decltype(safe_types::meters{} * safe_types::seconds{} * safe_types::grams{} * safe_types::bytes{})>.size() == 7,
+        "four dimensions are named");
+    using cubic_km_per_gram_second = decltype(safe_types::kilometers{} * safe_types::kilometers{} * safe_types::kilometers{} / (safe_types::seconds{} * safe_types::grams{}));
+    static_assert(unit_symbol_v<cubic_km_per_gram_second> == "km^3/(s*g)" || unit_symbol_v<cubic_km_per_gram_second> == "km^3/(g*s)",
+        "the fewest factors are scaled");
+    static_assert(unit_symbol_v<decltype(safe_types::nautical_miles{} * safe_types::weeks{} * safe_types::kilograms{} * safe_types::kilobytes{})>.empty(),
+        "names scaling more than max_scaled_factors factors are not synthesized");
+
+    class CountDim;
+    static_assert(unit_symbol_v<safe_types::singleton<int, CountDim>>.empty(), "dimensions without units have no symbol");
+
+    char buffer[32];
+    const auto speed = safe_types::kilometers{ 90 } / safe_types::hours{ 1 };
+    const auto end = safe_types::to_chars(buffer, buffer + sizeof(buffer), speed).ptr;
+    REQUIRE(std::string(buffer, end) == "90km/h");
+    decltype(safe_types::meters{} / safe_types::seconds{}) read;
+    REQUIRE(safe_types::from_chars(buffer, end, read).ec == std::errc::invalid_argument);
+}
+
+TEST_CASE("test to_chars", "[charconv]")
+{
+    const auto text = [](const auto& value) {
+        char buffer[32];
+        const auto result = safe_types::to_chars(buffer, buffer + sizeof(buffer), value);
+        REQUIRE(result.ec == std::errc{});
+        return std::string(buffer, result.ptr);
+    };
+    REQUIRE(text(safe_types::milliseconds{ 1500 }) == "1500ms");
+    REQUIRE(text(safe_types::nanoseconds{ -7 }) == "-7ns");
+    REQUIRE(text(safe_types::hours{ 2 }) == "2h");
+    REQUIRE(text(safe_types::kilometers{ 12 }) == "12km");
+    REQUIRE(text(safe_types::nautical_miles{ 3 }) == "3nmi");
+    REQUIRE(text(safe_types::simple_type<double, std::ratio<1073741824>, safe_types::MemoryVolumeDim>{ 3.2 }) == "3.2GiB");
+    REQUIRE(text(safe_types::simple_type<float, std::ratio<2, 2000>, safe_types::DurationDim>{ 0.5f }) == "0.5ms");
+
+    class CountDim;
+    REQUIRE(text(safe_types::singleton<unsigned, CountDim>{ 42 }) == "42");
+
+    char buffer[32];
+    const safe_types::simple_type<double, std::ratio<1>, safe_types::DurationDim> seconds{ 1.0 / 3 };
+    const auto fixed = safe_types::to_chars(buffer, buffer + sizeof(buffer), seconds, std::chars_format::fixed, 2);
+    REQUIRE(std::string(buffer, fixed.ptr) == "0.33s");
+
+    // the number fits but the symbol does not, and the other way round
+    const auto no_symbol = safe_types::to_chars(buffer, buffer + 5, safe_types::milliseconds{ 1500 });
+    REQUIRE(no_symbol.ec == std::errc::value_too_large);
+    REQUIRE(no_symbol.ptr == buffer + 5);
+    const auto no_number = safe_types::to_chars(buffer, buffer + 3, safe_types::milliseconds{ 1500 });
+    REQUIRE(no_number.ec == std::errc::value_too_large);
+    REQUIRE(no_number.ptr == buffer + 3);
+}
+
+TEST_CASE("test from_chars", "[charconv]")
+{
+    const auto parse = [](std::string_view text, auto& value) {
+        const auto result = safe_types::from_chars(text.data(), text.data() + text.size(), value);
+        REQUIRE((result.ec != std::errc{} || result.ptr == text.data() + text.size()));
+        return result.ec;
+    };
+    safe_types::milliseconds duration;
+    REQUIRE(parse("250ms", duration) == std::errc{});
+    REQUIRE(duration == safe_types::milliseconds{ 250 });
+    REQUIRE(parse("1.5s", duration) == std::errc{});
+    REQUIRE(duration == safe_types::milliseconds{ 1500 });
+    REQUIRE(parse("3min", duration) == std::errc{});
+    REQUIRE(duration == safe_types::minutes{ 3 });
+    REQUIRE(parse("-2h", duration) == std::errc{});
+    REQUIRE(duration == safe_types::hours{ -2 });
+    REQUIRE(parse("2500us", duration) == std::errc{});
+    REQUIRE(duration == safe_types::milliseconds{ 2 });
+    REQUIRE(parse("1e3ns", duration) == std::errc{});
+    REQUIRE(duration == safe_types::milliseconds{ 0 });
+
+    safe_types::meters distance;
+    REQUIRE(parse("12.5km", distance) == std::errc{});
+    REQUIRE(distance == safe_types::meters{ 12500 });
+    REQUIRE(parse("7mm", distance) == std::errc{});
+    REQUIRE(distance == safe_types::meters{ 0 });
+    REQUIRE(parse("2mi", distance) == std::errc{});
+    REQUIRE(distance == safe_types::cast<safe_types::meters>(safe_types::miles{ 2 }));
+    REQUIRE(parse("1nmi", distance) == std::errc{});
+    REQUIRE(distance == safe_types::meters{ 1852 });
+
+    safe_types::simple_type<double, std::ratio<1>, safe_types::MemoryVolumeDim> volume;
+    REQUIRE(parse("4GiB", volume) == std::errc{});
+    REQUIRE(volume.value() == 4294967296.0);
+    safe_types::simple_type<unsigned long long, std::ratio<1>, safe_types::MemoryVolumeDim> size;
+    REQUIRE(parse("512KiB", size) == std::errc{});
+    REQUIRE(size.value() == 524288u);
+    REQUIRE(parse("-1B", size) == std::errc::result_out_of_range);
+    REQUIRE(parse("18446744073709551615B", size) == std::errc{});
+    REQUIRE(size.value() == std::numeric_limits<unsigned long long>::max());
+    REQUIRE(parse("18446744073709551616B", size) == std::errc::result_out_of_range);
+    REQUIRE(parse("16777216TiB", size) == std::errc::result_out_of_range);
+    REQUIRE(parse("-0B", size) == std::errc{});
+    REQUIRE(size.value() == 0u);
+    REQUIRE(parse("--1B", size) == std::errc::invalid_argument);
+
+    class CountDim;
+    safe_types::singleton<int, CountDim> count;
+    REQUIRE(parse("42", count) == std::errc{});
+    REQUIRE(count.value() == 42);
+
+    // no symbol, a symbol of another dimension, no number, out of range
+    REQUIRE(parse("250", duration) == std::errc::invalid_argument);
+    REQUIRE(parse("250km", duration) == std::errc::invalid_argument);
+    REQUIRE(parse("ms", duration) == std::errc::invalid_argument);
+    REQUIRE(parse("99999999999999999999ms", duration) == std::errc::result_out_of_range);
+
+    // converted values that do not fit the underlying type leave the value unchanged
+    safe_types::minutes minutes{ 7 };
+    REQUIRE(parse("3000000000min", minutes) == std::errc::result_out_of_range);
+    REQUIRE(parse("1e30min", minutes) == std::errc::result_out_of_range);
+    REQUIRE(minutes == safe_types::minutes{ 7 });
+    REQUIRE(parse("2147483647min", minutes) == std::errc{});
+    REQUIRE(minutes.value() == 2147483647);
+    safe_types::simple_type<unsigned, std::ratio<1>, safe_types::MemoryVolumeDim> small_size;
+    REQUIRE(parse("5000000000B", small_size) == std::errc::result_out_of_range);
+    REQUIRE(parse("4294967295B", small_size) == std::errc{});
+    REQUIRE(parse("4GiB", small_size) == std::errc::result_out_of_range);
+    REQUIRE(parse("9223372036854775807s", duration) == std::errc::result_out_of_range);
+    REQUIRE(parse("9223372036854775807ms", duration) == std::errc{});
+    REQUIRE(duration.value() == std::numeric_limits<long long>::max());
+    REQUIRE(parse("1e30ms", duration) == std::errc::result_out_of_range);
+    REQUIRE(parse("-1e30ms", duration) == std::errc::result_out_of_range);
+    safe_types::simple_type<float, std::ratio<1>, safe_types::DurationDim> float_seconds;
+    REQUIRE(parse("1e300s", float_seconds) == std::errc::result_out_of_range);
+    REQUIRE(parse("1e30s", float_seconds) == std::errc{});
+
+    // the longest symbol wins and the rest of the text is left to the caller
+    const std::string_view text = "5mins";
+    const auto result = safe_types::from_chars(text.data(), text.data() + text.size(), duration);
+    REQUIRE(result.ec == std::errc{});
+    REQUIRE(result.ptr == text.data() + 4);
+    REQUIRE(duration == safe_types::minutes{ 5 });
+
+    // round trip through to_chars
+    char buffer[32];
+    const safe_types::nanoseconds written{ 123456789 };
+    safe_types::nanoseconds read;
+    const auto end = safe_types::to_chars(buffer, buffer + sizeof(buffer), written).ptr;
+    REQUIRE(safe_types::from_chars(buffer, end, read).ptr == end);
+    REQUIRE(read == written);
+}
+
+TEST_CASE("test quantity_format", "[format]")
+{
+    const auto text = [](const auto& value, std::string_view spec) {
+        safe_types::quantity_format format;
+        auto end = spec.begin();
+        REQUIRE(safe_types::internal::parse_quantity_format(end, spec.end(), format));
+        REQUIRE(end == spec.end());
+        char buffer[64];
+        const auto result = safe_types::to_chars(buffer, buffer + sizeof(buffer), value, format);
+        REQUIRE(result.ec == std::errc{});
+        return std::string(buffer, result.ptr);
+    };
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, "") == "1500ms");
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, "s") == "1.5s");
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, "ms") == "1500ms");
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, ".2s") == "1.50s");
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, ".1") == "1500.0ms");
+    REQUIRE(text(safe_types::milliseconds{ 9 }, "s") == "0.009s");
+    REQUIRE(text(safe_types::simple_type<double, std::milli, safe_types::DurationDim>{ 9.0 }, "s") == "0.009s");
+    REQUIRE(text(safe_types::seconds{ 90 }, "min") == "1.5min");
+    REQUIRE(text(safe_types::milliseconds{ 1500 }, ".0s") == "2s");
+    REQUIRE(text(safe_types::milliseconds{ 2500 }, ".0s") == "2s");
+    REQUIRE(text(safe_types::milliseconds{ -1999 }, ".2s") == "-2.00s");
+    REQUIRE(text(safe_types::milliseconds{ 9999 }, ".2s") == "10.00s");
+    REQUIRE(text(safe_types::nanoseconds{ (1LL << 60) + 1 }, ".0") == "1152921504606846977ns");
+    REQUIRE(text(safe_types::nanoseconds{ (1LL << 60) + 1 }, ".2") == "1152921504606846977.00ns");
+    REQUIRE(text(safe_types::nanoseconds{ (1LL << 60) + 1 }, ".3us") == "1152921504606846.977us");
+
+    REQUIRE(text(safe_types::bytes{ 1536 }, "a") == "1.5KiB");
+    REQUIRE(text(safe_types::bytes{ 1536 }, ".3a") == "1.500KiB");
+    REQUIRE(text(safe_types::bytes{ 3 * 1073741824LL + 214748365LL }, "a") == "3.2GiB");
+    REQUIRE(text(safe_types::bytes{ 512 }, "a") == "512B");
+    REQUIRE(text(safe_types::nanoseconds{ 1250000 }, "a") == "1.25ms");
+    REQUIRE(text(safe_types::nanoseconds{ -250000 }, "a") == "-250us");
+    // the unit is picked after rounding
+    REQUIRE(text(safe_types::nanoseconds{ 999999 }, "a") == "1ms");
+    REQUIRE(text(safe_types::bytes{ 1048575 }, "a") == "1MiB");
+    REQUIRE(text(safe_types::bytes{ 1048575 }, ".8a") == "1023.99902344KiB");
+    REQUIRE(text(safe_types::seconds{ 0 }, "a") == "0s");
+    REQUIRE(text(safe_types::simple_type<double, std::pico, safe_types::DurationDim>{ 5.0 }, "a") == "0.01ns");
+    // compound units have no other units to scale to
+    REQUIRE(text(safe_types::kilometers{ 90 } / safe_types::hours{ 1 }, "a") == "90km/h");
+
+    safe_types::quantity_format format;
+    std::string_view spec = ".x";
+    auto end = spec.begin();
+    REQUIRE(!safe_types::internal::parse_quantity_format(end, spec.end(), format));
+    format.unit = "km";
+    char buffer[64];
+    REQUIRE(safe_types::to_chars(buffer, buffer + sizeof(buffer), safe_types::seconds{ 1 }, format).ec == std::errc::invalid_argument);
+}
+
+#if defined(__cpp_lib_format)
+TEST_CASE("test std::format", "[format]")
+{
+    REQUIRE(std::format("{}", safe_types::milliseconds{ 1500 }) == "1500ms");
+    REQUIRE(std::format("{:s}", safe_types::milliseconds{ 9 }) == "0.009s");
+    REQUIRE(std::format("{:.1a}", safe_types::bytes{ 1536 }) == "1.5KiB");
+    REQUIRE(std::format("{:>4}|{:.2}", 7, safe_types::seconds{ 3 }) == "   7|3.00s");
+    const safe_types::seconds second{ 1 };
+    REQUIRE_THROWS_AS(std::vformat("{:km}", std::make_format_args(second)), std::format_error);
+}
+#endif
+
+TEST_CASE("test serialize", "[serialize]")
+{
+    const safe_types::quantity_vector<safe_types::milliseconds> latencies{
+        safe_types::milliseconds{ 1 }, safe_types::milliseconds{ -250 }, safe_types::milliseconds{ 1500 } };
+    std::vector<char> block(safe_types::encoded_size<safe_types::milliseconds>(latencies.size()));
+    const auto written = safe_types::encode(block.data(), block.data() + block.size(), latencies);
+    REQUIRE(written.ec == std::errc{});
+    REQUIRE(written.ptr == block.data() + block.size());
+    const char* const first = block.data();
+    const char* const last = block.data() + block.size();
+
+    // same unit: copied as is
+    safe_types::quantity_vector<safe_types::milliseconds> same;
+    const auto read = safe_types::decode(first, last, same);
+    REQUIRE(read.ec == std::errc{});
+    REQUIRE(read.ptr == last);
+    REQUIRE(std::vector<safe_types::milliseconds>(same.begin(), same.end()) == std::vector<safe_types::milliseconds>(latencies.begin(), latencies.end()));
+
+    // another unit of the dimension: converted as by cast
+    safe_types::quantity_vector<safe_types::microseconds> finer;
+    REQUIRE(safe_types::decode(first, last, finer).ec == std::errc{});
+    REQUIRE(finer[1] == safe_types::microseconds{ -250000 });
+    safe_types::quantity_vector<safe_types::seconds> coarser;
+    REQUIRE(safe_types::decode(first, last, coarser).ec == std::errc{});
+    REQUIRE(coarser[2] == safe_types::cast<safe_types::seconds>(safe_types::milliseconds{ 1500 }));
+    safe_types::quantity_vector<safe_types::simple_type<double, std::ratio<1>, safe_types::DurationDim>> real;
+    REQUIRE(safe_types::decode(first, last, real).ec == std::errc{});
+    REQUIRE(real[2].value() == 1.5);
+
+    // another underlying type: minutes are int
+    std::vector<char> minutes_block(safe_types::encoded_size<safe_types::minutes>(1));
+    REQUIRE(safe_types::encode(minutes_block.data(), minutes_block.data() + minutes_block.size(), safe_types::minutes{ 3 }).ec == std::errc{});
+    safe_types::seconds seconds;
+    REQUIRE(safe_types::decode(minutes_block.data(), minutes_block.data() + minutes_block.size(), seconds).ec == std::errc{});
+    REQUIRE(seconds == safe_types::seconds{ 180 });
+
+    // converted values that do not fit: int64 seconds read as int minutes, 1e300 read as long long
+    const safe_types::seconds huge{ 9000000000000000000LL };
+    std::vector<char> huge_block(safe_types::encoded_size<safe_types::seconds>(1));
+    REQUIRE(safe_types::encode(huge_block.data(), huge_block.data() + huge_block.size(), huge).ec == std::errc{});
+    safe_types::quantity_vector<safe_types::minutes> narrow(3, safe_types::minutes{ 1 });
+    const auto narrowed = safe_types::decode(huge_block.data(), huge_block.data() + huge_block.size(), narrow);
+    REQUIRE(narrowed.ec == std::errc::result_out_of_range);
+    REQUIRE(narrowed.ptr == huge_block.data() + huge_block.size());
+    REQUIRE(narrow.empty());
+    using real_seconds = safe_types::simple_type<double, std::ratio<1>, safe_types::DurationDim>;
+    std::vector<char> real_block(safe_types::encoded_size<real_seconds>(1));
+    REQUIRE(safe_types::encode(real_block.data(), real_block.data() + real_block.size(), real_seconds{ 1e300 }).ec == std::errc{});
+    safe_types::seconds unchanged{ 7 };
+    REQUIRE(safe_types::decode(real_block.data(), real_block.data() + real_block.size(), unchanged).ec == std::errc::result_out_of_range);
+    REQUIRE(unchanged == safe_types::seconds{ 7 });
+    REQUIRE(safe_types::decode(huge_block.data(), huge_block.data() + huge_block.size(), unchanged).ec == std::errc{});
+    REQUIRE(unchanged == huge);
+
+    // fingerprints hash dimension_id names, not type names, so they are the same for every compiler
+    static_assert(safe_types::internal::make_fingerprint<std::milli, safe_types::milliseconds::dimensions>() == 0xf0d2655c3b847208ull,
+        "the fingerprint of a unit is part of the encoded format");
+
+    // another dimension, an unknown unit, a truncated block, not a block
+    safe_types::quantity_vector<safe_types::meters> distances;
+    REQUIRE(safe_types::decode(first, last, distances).ec == std::errc::invalid_argument);
+    REQUIRE(distances.empty());
+    using weeks_and_a_bit = safe_types::simple_type<long long, std::ratio<7>, safe_types::DurationDim>;
+    safe_types::quantity_vector<weeks_and_a_bit> odd(2, weeks_and_a_bit{ 5 });
+    std::vector<char> odd_block(safe_types::encoded_size<weeks_and_a_bit>(odd.size()));
+    REQUIRE(safe_types::encode(odd_block.data(), odd_block.data() + odd_block.size(), odd).ec == std::errc{});
+    REQUIRE(safe_types::decode(odd_block.data(), odd_block.data() + odd_block.size(), same).ec == std::errc::invalid_argument);
+    safe_types::quantity_vector<weeks_and_a_bit> odd_read;
+    REQUIRE(safe_types::decode(odd_block.data(), odd_block.data() + odd_block.size(), odd_read).ec == std::errc{});
+    REQUIRE(odd_read[1] == weeks_and_a_bit{ 5 });
+    REQUIRE(safe_types::decode(first, last - 1, same).ec == std::errc::message_size);
+    REQUIRE(safe_types::decode(first, first + 4, same).ec == std::errc::message_size);
+    block[0] ^= 1;
+    REQUIRE(safe_types::decode(first, last, same).ec == std::errc::invalid_argument);
+
+    // the buffer is too small, a block of several values read as one
+    REQUIRE(safe_types::encode(block.data(), block.data() + block.size() - 1, latencies).ec == std::errc::value_too_large);
+    block[0] ^= 1;
+    safe_types::milliseconds single;
+    REQUIRE(safe_types::decode(first, last, single).ec == std::errc::invalid_argument);
 }
 
 TEST_CASE("test type equality", "[complex]")
@@ -124,6 +967,45 @@ TEST_CASE("test type equality", "[complex]")
     REQUIRE(safe_types::is_same<one_type, two_type>::value == true);
 }
 
+TEST_CASE("test canonical dimensions", "[complex]")
+{
+    using namespace safe_types;
+    using distance_time = decltype(std::declval<meters>() * std::declval<seconds>());
+    using time_distance = decltype(std::declval<seconds>() * std::declval<meters>());
+    static_assert(std::is_same<distance_time, time_distance>::value, "product should not depend on the operand order");
+
+    using acceleration1 = decltype(std::declval<millimeters>() / std::declval<seconds>() / std::declval<seconds>());
+    using acceleration2 = decltype(std::declval<millimeters>() / (std::declval<seconds>() * std::declval<seconds>()));
+    static_assert(std::is_same<acceleration1, acceleration2>::value, "quotient should not depend on the grouping");
+
+    using force1 = decltype(std::declval<kilograms>() * std::declval<acceleration1>());
+    using force2 = decltype(std::declval<acceleration2>() * std::declval<kilograms>());
+    static_assert(std::is_same<force1, force2>::value, "compound units should be canonical");
+
+    using unsorted = internal::make_dimensions<internal::tuple_dim<DurationDim, DistanceDim, DurationDim>, internal::tuple_dim<DurationDim>>;
+    using sorted = internal::make_dimensions<internal::tuple_dim<DistanceDim, DurationDim>, internal::tuple_dim<>>;
+    static_assert(std::is_same<unsorted, sorted>::value, "make_dimensions should sort and cancel");
+    static_assert(std::is_same<distance_time::dimensions, sorted>::value, "operators should produce canonical dimensions");
+}
+
+TEST_CASE("test dimension exponents", "[complex]")
+{
+    using namespace safe_types;
+    using cubic = decltype(std::declval<meters>() * std::declval<meters>() * std::declval<meters>());
+    using expected = internal::dim_ratio<internal::tuple_dim<internal::dim_power<DistanceDim, 3>>, internal::tuple_dim<>>;
+    static_assert(std::is_same<cubic::dimensions, expected>::value, "repeated dimensions should be one power entry");
+
+    using flow1 = decltype(std::declval<cubic>() / std::declval<seconds>() / std::declval<seconds>());
+    using flow2 = decltype(std::declval<meters>() / std::declval<seconds>() * std::declval<meters>() / std::declval<seconds>() * std::declval<meters>());
+    static_assert(std::is_same<flow1, flow2>::value, "powers should not depend on how they were produced");
+
+    using area = decltype(std::declval<cubic>() / std::declval<meters>());
+    using square = decltype(std::declval<meters>() * std::declval<meters>());
+    static_assert(std::is_same<area, square>::value, "division should subtract exponents");
+    REQUIRE(cubic{ 8 } / meters{ 2 } == square{ 4 });
+    REQUIRE(flow1{ 6 } * seconds{ 2 } * seconds{ 1 } / square{ 3 } == meters{ 4 });
+}
+
 TEST_CASE("test order", "[complex]")
 {
     using acceleration = decltype(std::declval<safe_types::millimeters>() / std::declval<safe_types::seconds>() / std::declval<safe_types::seconds>());
@@ -188,3 +1070,266 @@ TEST_CASE("copy", "[complex]")
     auto d = std::move(b); // 3
     REQUIRE(A::count == 3);
 }
+
+struct CopyCounter
+{
+    static size_t copies;
+    std::string payload = "payload which does not fit into small string buffer";
+    CopyCounter() = default;
+    CopyCounter(CopyCounter const& other) : payload{ other.payload } { copies++; }
+    CopyCounter& operator= (CopyCounter const& other) { payload = other.payload; copies++; return *this; }
+    CopyCounter(CopyCounter&&) noexcept = default;
+    CopyCounter& operator= (CopyCounter&&) noexcept = default;
+};
+
+size_t CopyCounter::copies = 0;
+
+TEST_CASE("test noexcept propagation", "[singleton]")
+{
+    class StringDim;
+    using SomeString = safe_types::singleton<std::string, StringDim>;
+    static_assert(std::is_nothrow_move_constructible<SomeString>::value, "string singleton should be nothrow movable");
+    static_assert(std::is_nothrow_move_assignable<SomeString>::value, "string singleton should be nothrow move assignable");
+    static_assert(!std::is_nothrow_copy_constructible<SomeString>::value, "string singleton copy may throw");
+    static_assert(!noexcept(SomeString{ "a" } == SomeString{ "b" }), "constructing string singletons may throw");
+    static_assert(noexcept(std::declval<const SomeString&>() == std::declval<const SomeString&>()), "string comparison does not copy the values");
+    static_assert(noexcept(std::declval<const SomeString&>() < std::declval<const SomeString&>()), "string comparison does not copy the values");
+    static_assert(noexcept(safe_types::meters{ 1 } + safe_types::kilometers{ 1 }), "integral sum should be noexcept");
+    static_assert(noexcept(safe_types::meters{ 1 } < safe_types::kilometers{ 1 }), "integral comparison should be noexcept");
+
+    class ADim;
+    using AS = safe_types::singleton<A, ADim>;
+    static_assert(!std::is_nothrow_move_constructible<AS>::value, "A move may throw");
+}
+
+TEST_CASE("test vector growth moves", "[singleton]")
+{
+    class CounterDim;
+    using Counter = safe_types::singleton<CopyCounter, CounterDim>;
+    std::vector<Counter> counters;
+    CopyCounter::copies = 0;
+    for (int i = 0; i < 1000; ++i) {
+        counters.emplace_back(CopyCounter{});
+    }
+    REQUIRE(CopyCounter::copies == 0);
+}
+
+template<typename... CTs>
+struct has_raw_layout : std::integral_constant<bool, ((
+    std::is_trivially_copyable<CTs>::value &&
+    sizeof(CTs) == sizeof(typename CTs::underlying_type) &&
+    alignof(CTs) == alignof(typename CTs::underlying_type)) && ...)>
+{};
+
+TEST_CASE("test trivially copyable layout", "[layout]")
+{
+    using namespace safe_types;
+    static_assert(has_raw_layout<micrometers, millimeters, centimeters, decimeters, meters, kilometers,
+        inches, feet, yards, miles, nautical_miles>::value, "distance types should have the layout of the underlying type");
+    static_assert(has_raw_layout<nanoseconds, microseconds, milliseconds, seconds, minutes, hours, days, weeks>::value,
+        "duration types should have the layout of the underlying type");
+    static_assert(has_raw_layout<milligrams, grams, kilograms, tonnes>::value, "weight types should have the layout of the underlying type");
+    static_assert(has_raw_layout<bytes, kilobytes, megabytes, gigabytes, terabytes>::value,
+        "memory volume types should have the layout of the underlying type");
+    using acceleration = decltype(std::declval<millimeters>() / std::declval<seconds>() / std::declval<seconds>());
+    static_assert(has_raw_layout<acceleration>::value, "derived types should have the layout of the underlying type");
+
+    const std::vector<meters> source{ meters{ 1 }, meters{ 2 }, meters{ 3 } };
+    std::vector<long long> raw(source.size());
+    std::memcpy(raw.data(), source.data(), source.size() * sizeof(meters));
+    REQUIRE(raw == std::vector<long long>{ 1, 2, 3 });
+}
+
+TEST_CASE("test quantity_vector", "[quantity_vector]")
+{
+    safe_types::quantity_vector<safe_types::bytes> sizes{ safe_types::bytes{ 1024 }, safe_types::bytes{ 2048 } };
+    sizes.push_back(safe_types::bytes{ 4096 });
+    sizes[0] += safe_types::bytes{ 1024 };
+    REQUIRE(sizes.size() == 3);
+    REQUIRE(sizes[0] == safe_types::kilobytes{ 2 });
+
+    const auto raw = sizes.raw();
+    REQUIRE(raw[2] == 4096);
+    REQUIRE(static_cast<const void*>(raw.data()) == static_cast<const void*>(sizes.values().data()));
+    // typed elements and raw values are the same storage
+    sizes.raw()[1] = 3072;
+    REQUIRE(sizes[1] == safe_types::bytes{ 3072 });
+    sizes[1] = safe_types::bytes{ 2048 };
+    REQUIRE(raw[1] == 2048);
+    REQUIRE(&*(sizes.begin() + 2) == &sizes[2]);
+    REQUIRE(sizes.emplace_back(8192).value() == 8192);
+    REQUIRE(sizes.raw()[3] == 8192);
+    sizes.resize(3);
+
+    safe_types::span<const safe_types::bytes> view = sizes.values();
+    REQUIRE(view.size() == 3);
+    REQUIRE(view[1] == safe_types::bytes{ 2048 });
+
+    const auto kilobytes = sizes.as<safe_types::kilobytes>();
+    REQUIRE(kilobytes.size() == 3);
+    REQUIRE(kilobytes[0].value() == 2);
+    REQUIRE(kilobytes[2].value() == 4);
+}
+
+template<typename From, typename To>
+void require_convert_matches_cast(const std::vector<From>& source)
+{
+    std::vector<To> converted(source.size());
+    safe_types::convert(safe_types::span<const From>{ source }, safe_types::span<To>{ converted });
+    for (size_t i = 0; i < source.size(); ++i) {
+        REQUIRE(converted[i].value() == To(source[i]).value());
+    }
+}
+
+TEST_CASE("test bulk convert", "[convert]")
+{
+    using namespace safe_types;
+    std::vector<meters> distances;
+    std::vector<bytes> sizes;
+    std::vector<minutes> durations;
+    for (long long i = -50; i < 53; ++i) {
+        distances.push_back(meters{ i * 7919 });
+        sizes.push_back(bytes{ i * 104729 });
+        durations.push_back(minutes{ static_cast<int>(i) });
+    }
+    require_convert_matches_cast<meters, millimeters>(distances);
+    require_convert_matches_cast<meters, kilometers>(distances);
+    require_convert_matches_cast<meters, inches>(distances);
+    require_convert_matches_cast<meters, meters>(distances);
+    require_convert_matches_cast<bytes, kilobytes>(sizes);
+    require_convert_matches_cast<minutes, seconds>(durations);
+
+    class TimeDim;
+    using float_seconds = simple_type<double, std::ratio<1>, TimeDim>;
+    using float_hours = simple_type<double, std::ratio<3600>, TimeDim>;
+    using float_ms = simple_type<float, std::milli, TimeDim>;
+    using float_s = simple_type<float, std::ratio<1>, TimeDim>;
+    std::vector<float_seconds> times;
+    std::vector<float_ms> short_times;
+    for (int i = 0; i < 37; ++i) {
+        times.push_back(float_seconds{ i * 1.37 });
+        short_times.push_back(float_ms{ i * 11.1f });
+    }
+    require_convert_matches_cast<float_seconds, float_hours>(times);
+    require_convert_matches_cast<float_hours, float_seconds>(std::vector<float_hours>{ float_hours{ 0.5 }, float_hours{ 1.25 }, float_hours{ 3 } });
+    require_convert_matches_cast<float_ms, float_s>(short_times);
+}
+
+#if defined(SAFE_TYPES_X86)
+TEST_CASE("test simd kernels", "[convert]")
+{
+    std::vector<long long> values;
+    std::vector<double> reals;
+    for (long long i = -1000003; i < 1000003; i += 9973) {
+        values.push_back(i * 1234567);
+        reals.push_back(static_cast<double>(i) / 7);
+    }
+    std::vector<long long> products(values.size());
+    std::vector<long long> quotients(values.size());
+    std::vector<double> scaled(reals.size());
+    const auto rec = safe_types::internal::signed_reciprocal(196847);
+    const auto done_products = safe_types::internal::multiply_sse2(values.data(), products.data(), values.size(), 1000LL);
+    const auto done_quotients = safe_types::internal::divide_sse2(values.data(), quotients.data(), values.size(), rec);
+    const auto done_scaled = safe_types::internal::scale_sse2<true, true>(reals.data(), scaled.data(), reals.size(), 3.0, 3600.0);
+    for (size_t i = 0; i < done_products; ++i) {
+        REQUIRE(products[i] == values[i] * 1000);
+    }
+    for (size_t i = 0; i < done_quotients; ++i) {
+        REQUIRE(quotients[i] == values[i] / 196847);
+    }
+    for (size_t i = 0; i < done_scaled; ++i) {
+        REQUIRE(scaled[i] == reals[i] * 3.0 / 3600.0);
+    }
+    if (safe_types::internal::simd_support() == safe_types::internal::simd_level::avx2) {
+        std::fill(products.begin(), products.end(), 0);
+        std::fill(quotients.begin(), quotients.end(), 0);
+        std::fill(scaled.begin(), scaled.end(), 0.0);
+        const auto avx2_products = safe_types::internal::multiply_avx2(values.data(), products.data(), values.size(), 1000LL);
+        const auto avx2_quotients = safe_types::internal::divide_avx2(values.data(), quotients.data(), values.size(), rec);
+        const auto avx2_scaled = safe_types::internal::scale_avx2<true, true>(reals.data(), scaled.data(), reals.size(), 3.0, 3600.0);
+        REQUIRE(avx2_products > 0);
+        REQUIRE(avx2_quotients > 0);
+        REQUIRE(avx2_scaled > 0);
+        for (size_t i = 0; i < avx2_products; ++i) {
+            REQUIRE(products[i] == values[i] * 1000);
+        }
+        for (size_t i = 0; i < avx2_quotients; ++i) {
+            REQUIRE(quotients[i] == values[i] / 196847);
+        }
+        for (size_t i = 0; i < avx2_scaled; ++i) {
+            REQUIRE(scaled[i] == reals[i] * 3.0 / 3600.0);
+        }
+    }
+}
+
+TEST_CASE("test simd division at the range limits", "[convert]")
+{
+    // the reciprocals cover a zero shift (3) and a negative multiplier (1000000007)
+    std::vector<long long> values = { 0, 1, -1, 2, -2, 6, -6, 7, -7, 999, -999, 1000, -1000, 1001, -1001,
+        std::numeric_limits<long long>::max(), std::numeric_limits<long long>::min(),
+        std::numeric_limits<long long>::max() - 1, std::numeric_limits<long long>::min() + 1 };
+    for (long long i = 1; i < 64; ++i) {
+        values.push_back(static_cast<long long>(uint64_t{ 1 } << (i - 1)) * (i % 2 == 0 ? 1 : -1) + i);
+    }
+    std::vector<long long> quotients(values.size());
+    for (const long long den : { 3LL, 7LL, 1000LL, 196847LL, 1000000007LL }) {
+        const auto rec = safe_types::internal::signed_reciprocal(den);
+        std::fill(quotients.begin(), quotients.end(), 0);
+        const auto done = safe_types::internal::divide_sse2(values.data(), quotients.data(), values.size(), rec);
+        REQUIRE(done == values.size() / 2 * 2);
+        for (size_t i = 0; i < done; ++i) {
+            REQUIRE(quotients[i] == values[i] / den);
+        }
+        if (safe_types::internal::simd_support() == safe_types::internal::simd_level::avx2) {
+            std::fill(quotients.begin(), quotients.end(), 0);
+            const auto avx2_done = safe_types::internal::divide_avx2(values.data(), quotients.data(), values.size(), rec);
+            REQUIRE(avx2_done == values.size() / 4 * 4);
+            for (size_t i = 0; i < avx2_done; ++i) {
+                REQUIRE(quotients[i] == values[i] / den);
+            }
+        }
+    }
+    std::vector<safe_types::millimeters> millimeters;
+    for (const auto value : values) {
+        millimeters.push_back(safe_types::millimeters{ value });
+    }
+    std::vector<safe_types::meters> meters(millimeters.size());
+    safe_types::convert(safe_types::span<const safe_types::millimeters>{ millimeters }, safe_types::span<safe_types::meters>{ meters });
+    for (size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(meters[i].value() == values[i] / 1000);
+    }
+}
+#endif
+
+TEST_CASE("test division by reciprocal", "[convert]")
+{
+    using safe_types::internal::divide_by_reciprocal;
+    static_assert(divide_by_reciprocal<393694>(-393695) == -1, "reciprocal division should truncate toward zero");
+    static_assert(divide_by_reciprocal<5000>(std::numeric_limits<int64_t>::min()) == std::numeric_limits<int64_t>::min() / 5000,
+        "reciprocal division should be exact at the range limits");
+    const int64_t dividends[] = { 0, 1, -1, 4999, 5000, 5001, -4999, -5000, -5001, 196846, 196847, 196848, -196847,
+        std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max() - 1 };
+    for (const auto dividend : dividends) {
+        REQUIRE(divide_by_reciprocal<5000>(dividend) == dividend / 5000);
+        REQUIRE(divide_by_reciprocal<196847>(dividend) == dividend / 196847);
+        REQUIRE(divide_by_reciprocal<3>(dividend) == dividend / 3);
+    }
+    for (int64_t dividend = -2000000; dividend < 2000000; dividend += 37) {
+        REQUIRE(divide_by_reciprocal<196847>(dividend * 5000) == dividend * 5000 / 196847);
+    }
+    REQUIRE(safe_types::meters(safe_types::miles{ 3 }).value() == 4828);
+    REQUIRE(safe_types::inches(safe_types::meters{ -1 }).value() == -39);
+}
+
+TEST_CASE("test conversion without intermediate overflow", "[convert]")
+{
+    using namespace safe_types;
+    REQUIRE(inches(meters{ 1000000000000000LL }).value() == 39369400000000000LL);
+    REQUIRE(inches(meters{ -1000000000000007LL }).value() == -39369400000000275LL);
+    REQUIRE(inches(meters{ 46116860184273879LL }).value() == 1815593115338752051LL);
+    REQUIRE(micrometers(miles{ 100000 }).value() == 160937174556889LL);
+    REQUIRE(micrometers(miles{ -100000 }).value() == -160937174556889LL);
+    REQUIRE(micrometers(miles{ 5000000000LL }).value() == 8046858727844468038LL);
+    REQUIRE(inches(meters{ 1000 }).value() == 39369);
+    REQUIRE(meters(feet{ std::numeric_limits<int>::max() }).value() == 654564300LL);
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "safe_types.h"
+#include "unit_symbol.h"
 
 namespace safe_types
 {
@@ -17,6 +18,20 @@ namespace safe_types
     using miles = simple_type<long long, std::ratio<633600000, 393694>, DistanceDim>;
     using nautical_miles = simple_type<long long, std::ratio<1852>, DistanceDim>;
 
+    template<> struct unit_symbol<micrometers::period::type, micrometers::dimensions> { static constexpr std::string_view value{ "um" }; };
+    template<> struct unit_symbol<millimeters::period::type, millimeters::dimensions> { static constexpr std::string_view value{ "mm" }; };
+    template<> struct unit_symbol<centimeters::period::type, centimeters::dimensions> { static constexpr std::string_view value{ "cm" }; };
+    template<> struct unit_symbol<decimeters::period::type, decimeters::dimensions> { static constexpr std::string_view value{ "dm" }; };
+    template<> struct unit_symbol<meters::period::type, meters::dimensions> { static constexpr std::string_view value{ "m" }; };
+    template<> struct unit_symbol<kilometers::period::type, kilometers::dimensions> { static constexpr std::string_view value{ "km" }; };
+    template<> struct unit_symbol<inches::period::type, inches::dimensions> { static constexpr std::string_view value{ "in" }; };
+    template<> struct unit_symbol<feet::period::type, feet::dimensions> { static constexpr std::string_view value{ "ft" }; };
+    template<> struct unit_symbol<yards::period::type, yards::dimensions> { static constexpr std::string_view value{ "yd" }; };
+    template<> struct unit_symbol<miles::period::type, miles::dimensions> { static constexpr std::string_view value{ "mi" }; };
+    template<> struct unit_symbol<nautical_miles::period::type, nautical_miles::dimensions> { static constexpr std::string_view value{ "nmi" }; };
+    template<> struct dimension_units<meters::dimensions> { using type = unit_list<micrometers, millimeters, centimeters, decimeters, meters, kilometers, inches, feet, yards, miles, nautical_miles>; };
+    template<> struct dimension_id<DistanceDim> { static constexpr std::string_view value{ "distance" }; };
+
     class DurationDim;
     using nanoseconds = simple_type<long long, std::nano, DurationDim>;
     using microseconds = simple_type<long long, std::micro, DurationDim>;
@@ -27,16 +42,42 @@ namespace safe_types
     using days = simple_type<int, std::ratio<86400>, DurationDim>;
     using weeks = simple_type<int, std::ratio<604800>, DurationDim>;
 
+    template<> struct unit_symbol<nanoseconds::period::type, nanoseconds::dimensions> { static constexpr std::string_view value{ "ns" }; };
+    template<> struct unit_symbol<microseconds::period::type, microseconds::dimensions> { static constexpr std::string_view value{ "us" }; };
+    template<> struct unit_symbol<milliseconds::period::type, milliseconds::dimensions> { static constexpr std::string_view value{ "ms" }; };
+    template<> struct unit_symbol<seconds::period::type, seconds::dimensions> { static constexpr std::string_view value{ "s" }; };
+    template<> struct unit_symbol<minutes::period::type, minutes::dimensions> { static constexpr std::string_view value{ "min" }; };
+    template<> struct unit_symbol<hours::period::type, hours::dimensions> { static constexpr std::string_view value{ "h" }; };
+    template<> struct unit_symbol<days::period::type, days::dimensions> { static constexpr std::string_view value{ "d" }; };
+    template<> struct unit_symbol<weeks::period::type, weeks::dimensions> { static constexpr std::string_view value{ "wk" }; };
+    template<> struct dimension_units<seconds::dimensions> { using type = unit_list<nanoseconds, microseconds, milliseconds, seconds, minutes, hours, days, weeks>; };
+    template<> struct dimension_id<DurationDim> { static constexpr std::string_view value{ "duration" }; };
+
     class WeightDim;
     using milligrams = simple_type<long long, std::milli, WeightDim>;
     using grams = simple_type<long long, std::ratio<1>, WeightDim>;
     using kilograms = simple_type<long long, std::kilo, WeightDim>;
     using tonnes = simple_type < long long, std::mega, WeightDim > ;
 
+    template<> struct unit_symbol<milligrams::period::type, milligrams::dimensions> { static constexpr std::string_view value{ "mg" }; };
+    template<> struct unit_symbol<grams::period::type, grams::dimensions> { static constexpr std::string_view value{ "g" }; };
+    template<> struct unit_symbol<kilograms::period::type, kilograms::dimensions> { static constexpr std::string_view value{ "kg" }; };
+    template<> struct unit_symbol<tonnes::period::type, tonnes::dimensions> { static constexpr std::string_view value{ "t" }; };
+    template<> struct dimension_units<grams::dimensions> { using type = unit_list<milligrams, grams, kilograms, tonnes>; };
+    template<> struct dimension_id<WeightDim> { static constexpr std::string_view value{ "weight" }; };
+
     class MemoryVolumeDim;
     using bytes = simple_type<long long, std::ratio<1>, MemoryVolumeDim>;
     using kilobytes = simple_type<long long, std::ratio<1024>, MemoryVolumeDim>;
     using megabytes = simple_type<long long, std::ratio<1048576>, MemoryVolumeDim>;
     using gigabytes = simple_type<long long, std::ratio<1073741824>, MemoryVolumeDim>;
     using terabytes = simple_type<long long, std::ratio<1099511627776>, MemoryVolumeDim>;
+
+    template<> struct unit_symbol<bytes::period::type, bytes::dimensions> { static constexpr std::string_view value{ "B" }; };
+    template<> struct unit_symbol<kilobytes::period::type, kilobytes::dimensions> { static constexpr std::string_view value{ "KiB" }; };
+    template<> struct unit_symbol<megabytes::period::type, megabytes::dimensions> { static constexpr std::string_view value{ "MiB" }; };
+    template<> struct unit_symbol<gigabytes::period::type, gigabytes::dimensions> { static constexpr std::string_view value{ "GiB" }; };
+    template<> struct unit_symbol<terabytes::period::type, terabytes::dimensions> { static constexpr std::string_view value{ "TiB" }; };
+    template<> struct dimension_units<bytes::dimensions> { using type = unit_list<bytes, kilobytes, megabytes, gigabytes, terabytes>; };
+    template<> struct dimension_id<MemoryVolumeDim> { static constexpr std::string_view value{ "memory_volume" }; };
 }
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <initializer_list>
+#include <vector>
+
+#include "convert.h"
+#include "safe_types.h"
+#include "span.h"
+
+namespace safe_types
+{
+    // contiguous column of quantities of one unit, stored as raw underlying values. The typed views
+    // (elements, iterators, values()) rely on the layout complex_type guarantees: standard layout,
+    // trivially copyable, with the value as its only member and no padding, as asserted below
+    template<typename CT>
+    class quantity_vector
+    {
+        static_assert(internal::_is_complex_type<CT>::value, "quantity_vector stores complex_type values");
+        static_assert(std::is_trivially_copyable<CT>::value && std::is_standard_layout<CT>::value &&
+            sizeof(CT) == sizeof(typename CT::underlying_type) && alignof(CT) == alignof(typename CT::underlying_type),
+            "quantity_vector requires the raw layout of the underlying type");
+
+    public:
+        using value_type = CT;
+        using underlying_type = typename CT::underlying_type;
+        using size_type = size_t;
+        using reference = CT&;
+        using const_reference = const CT&;
+        using iterator = CT*;
+        using const_iterator = const CT*;
+
+        quantity_vector() = default;
+
+        explicit quantity_vector(size_t count, const CT& value = CT{})
+            : m_values(count, value.value())
+        {
+        }
+
+        quantity_vector(std::initializer_list<CT> values)
+        {
+            m_values.reserve(values.size());
+            for (const CT& value : values) {
+                m_values.push_back(value.value());
+            }
+        }
+
+        size_t size() const noexcept
+        {
+            return m_values.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_values.empty();
+        }
+
+        size_t capacity() const noexcept
+        {
+            return m_values.capacity();
+        }
+
+        void reserve(size_t count)
+        {
+            m_values.reserve(count);
+        }
+
+        void resize(size_t count)
+        {
+            m_values.resize(count);
+        }
+
+        void clear() noexcept
+        {
+            m_values.clear();
+        }
+
+        void push_back(const CT& value)
+        {
+            m_values.push_back(value.value());
+        }
+
+        template<typename... Args>
+        CT& emplace_back(Args&&... args)
+        {
+            m_values.push_back(CT(std::forward<Args>(args)...).value());
+            return typed()[m_values.size() - 1];
+        }
+
+        CT& operator[](size_t index) noexcept
+        {
+            return typed()[index];
+        }
+
+        const CT& operator[](size_t index) const noexcept
+        {
+            return typed()[index];
+        }
+
+        iterator begin() noexcept
+        {
+            return typed();
+        }
+
+        iterator end() noexcept
+        {
+            return typed() + m_values.size();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return typed();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return typed() + m_values.size();
+        }
+
+        span<CT> values() noexcept
+        {
+            return span<CT>{ typed(), m_values.size() };
+        }
+
+        span<const CT> values() const noexcept
+        {
+            return span<const CT>{ typed(), m_values.size() };
+        }
+
+        span<underlying_type> raw() noexcept
+        {
+            return span<underlying_type>{ m_values.data(), m_values.size() };
+        }
+
+        span<const underlying_type> raw() const noexcept
+        {
+            return span<const underlying_type>{ m_values.data(), m_values.size() };
+        }
+
+        // one pass of internal::convert_values from the raw values of this column to those of the result
+        template<typename To, typename = internal::DimIsConvertible<typename To::dimensions, typename CT::dimensions>>
+        quantity_vector<To> as() const
+        {
+            quantity_vector<To> result(size());
+            internal::convert_values<typename To::underlying_type, typename CT::period, typename To::period>(
+                m_values.data(), result.raw().data(), size());
+            return result;
+        }
+
+    private:
+        CT* typed() noexcept
+        {
+            return reinterpret_cast<CT*>(m_values.data());
+        }
+
+        const CT* typed() const noexcept
+        {
+            return reinterpret_cast<const CT*>(m_values.data());
+        }
+
+        std::vector<underlying_type> m_values;
+    };
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 
 namespace safe_types
 {
@@ -68,6 +73,16 @@ namespace safe_types
         template<typename T>
         using enable_if_not_arithmetic = std::enable_if<std::is_arithmetic<T>::value>;
 
+        template<typename T>
+        constexpr bool is_nothrow_value_v = std::is_nothrow_copy_constructible<T>::value && std::is_nothrow_move_constructible<T>::value;
+
+        // operands and their common type can be copied and converted without throwing
+        template<typename T1, typename T2 = T1>
+        constexpr bool is_nothrow_operands_v =
+            is_nothrow_value_v<T1> && is_nothrow_value_v<T2> && is_nothrow_value_v<std::common_type_t<T1, T2>> &&
+            std::is_nothrow_constructible<std::common_type_t<T1, T2>, const T1&>::value &&
+            std::is_nothrow_constructible<std::common_type_t<T1, T2>, const T2&>::value;
+
         template<typename... Dims>
         struct tuple_dim {};
 
@@ -81,97 +96,372 @@ namespace safe_types
             using den = tuple_dim<Dens...>;
         };
 
-        template <typename T1, typename T2>
-        struct join;
+        template<typename T1>
+        struct is_degenerated
+        {};
+
+        template<>
+        struct is_degenerated<dim_ratio<tuple_dim<>, tuple_dim<>>> :
+            std::true_type
+        {};
+
+        template<typename T1, typename T2, typename...Ts1, typename... Ts2>
+        struct is_degenerated<dim_ratio<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>>> :
+            std::false_type
+        {};
 
-        template<typename ...Ts1, typename ...Ts2>
-        struct join<tuple_dim<Ts1...>, tuple_dim<Ts2...>>
+        template<typename T1, typename...Ts1>
+        struct is_degenerated<dim_ratio<tuple_dim<T1, Ts1...>, tuple_dim<>>> :
+            std::false_type
+        {};
+
+        template<typename T2, typename... Ts2>
+        struct is_degenerated<dim_ratio<tuple_dim<>, tuple_dim<T2, Ts2...>>> :
+            std::false_type
+        {};
+
+        // Canonical dimensions: both lists of a dim_ratio hold dim_power<Tag, Exponent> entries with
+        // positive exponents, sorted by a hash of the tag name and with no tag in both lists. Equal
+        // physical dimensions are the same C++ type (m*s and s*m included), and a dimension has
+        // one entry per tag however it was produced (m*m*m is dim_power<DistanceDim, 3>).
+        // Products and quotients of canonical dimensions are built by linear merges.
+
+        template<typename Tag, int Exponent>
+        struct dim_power
         {
-            using type = tuple_dim<Ts1..., Ts2...>;
+            using tag = Tag;
+            static constexpr int exponent = Exponent;
         };
 
-        template <typename T, typename Tuple, typename Res = tuple_dim<>>
-        struct remove;
-
-        template<typename T, typename Res>
-        struct remove<T, tuple_dim<>, Res>
+        template<typename T>
+        struct as_power
         {
-            using type = Res;
+            using type = dim_power<T, 1>;
         };
 
-        template<typename T, typename... Ts, typename... TRes>
-        struct remove<T, tuple_dim<T, Ts...>, tuple_dim<TRes...>>
+        template<typename Tag, int Exponent>
+        struct as_power<dim_power<Tag, Exponent>>
         {
-            using type = tuple_dim<TRes..., Ts...>;
+            using type = dim_power<Tag, Exponent>;
         };
 
-        template<typename T, typename T1, typename ...Ts, typename... TRes>
-        struct remove<T, tuple_dim<T1, Ts...>, tuple_dim<TRes...>> :
-            remove<T, tuple_dim<Ts...>, tuple_dim<TRes..., T1>>
-        {};
+        template<typename T>
+        constexpr std::string_view type_name() noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return __FUNCSIG__;
+#else
+            return __PRETTY_FUNCTION__;
+#endif
+        }
+
+        constexpr uint64_t fnv1a(std::string_view text) noexcept
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (const char c : text) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        // computed once per type, so ordering two dimensions is usually a single integer compare
+        template<typename T>
+        constexpr uint64_t type_key = fnv1a(type_name<T>());
+
+        template<typename T1, typename T2>
+        constexpr int type_compare() noexcept
+        {
+            if constexpr (std::is_same<T1, T2>::value) {
+                return 0;
+            }
+            else if constexpr (type_key<T1> != type_key<T2>) {
+                return type_key<T1> < type_key<T2> ? -1 : 1;
+            }
+            else {
+                static_assert(type_name<T1>() != type_name<T2>(), "dimension tags must have distinct names");
+                return type_name<T1>() < type_name<T2>() ? -1 : 1;
+            }
+        }
 
-        template<typename Tuple1, typename Tuple2>
-        struct remove_all {};
+        template<typename T, typename Tuple>
+        struct prepend;
 
-        template<typename ...Ts1>
-        struct remove_all<tuple_dim<Ts1...>, tuple_dim<>>
+        template<typename T, typename... Ts>
+        struct prepend<T, tuple_dim<Ts...>>
         {
-            using type = tuple_dim<Ts1...>;
+            using type = tuple_dim<T, Ts...>;
         };
 
-        template<typename ...Ts1, typename T, typename... Ts2>
-        struct remove_all<tuple_dim<Ts1...>, tuple_dim<T, Ts2...>>
-            : remove_all<typename remove<T, tuple_dim<Ts1...>>::type, tuple_dim<Ts2...>>
+        // prepends dim_power<Tag, Exponent> unless the exponent is zero
+        template<typename Tag, int Exponent, typename Tuple>
+        struct prepend_power : prepend<dim_power<Tag, Exponent>, Tuple>
         {};
 
-        template<typename T1, typename T2>
-        struct trim
-        {};
+        template<typename Tag, typename Tuple>
+        struct prepend_power<Tag, 0, Tuple>
+        {
+            using type = Tuple;
+        };
 
-        template<typename ...Ts1, typename ...Ts2>
-        struct trim<tuple_dim<Ts1...>, tuple_dim<Ts2...>>
+        template<typename Power1, typename Power2>
+        constexpr int power_compare() noexcept
         {
-            using num = typename remove_all<tuple_dim<Ts1...>, tuple_dim<Ts2...>>::type;
-            using den = typename remove_all<tuple_dim<Ts2...>, tuple_dim<Ts1...>>::type;
+            return type_compare<typename Power1::tag, typename Power2::tag>();
+        }
+
+        // merges two sorted power lists, adding the exponents of equal tags
+        template<typename Tuple1, typename Tuple2, int Compare = 2>
+        struct merge;
+
+        template<typename... Ts, int Compare>
+        struct merge<tuple_dim<>, tuple_dim<Ts...>, Compare>
+        {
+            using type = tuple_dim<Ts...>;
         };
 
-        template<typename T1>
-        struct is_degenerated
+        template<typename T, typename... Ts, int Compare>
+        struct merge<tuple_dim<T, Ts...>, tuple_dim<>, Compare>
+        {
+            using type = tuple_dim<T, Ts...>;
+        };
+
+        template<typename T1, typename... Ts1, typename T2, typename... Ts2>
+        struct merge<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>, 2>
+            : merge<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>, power_compare<T1, T2>()>
         {};
 
-        template<>
-        struct is_degenerated<dim_ratio<tuple_dim<>, tuple_dim<>>> :
-            std::true_type
+        template<typename T1, typename... Ts1, typename T2, typename... Ts2>
+        struct merge<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>, 0>
+            : prepend<dim_power<typename T1::tag, T1::exponent + T2::exponent>, typename merge<tuple_dim<Ts1...>, tuple_dim<Ts2...>>::type>
         {};
 
-        template<typename T1, typename T2, typename...Ts1, typename... Ts2>
-        struct is_degenerated<dim_ratio<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>>> :
-            std::false_type
+        template<typename T1, typename... Ts1, typename T2, typename... Ts2>
+        struct merge<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>, -1>
+            : prepend<T1, typename merge<tuple_dim<Ts1...>, tuple_dim<T2, Ts2...>>::type>
         {};
 
-        template<typename T1, typename...Ts1>
-        struct is_degenerated<dim_ratio<tuple_dim<T1, Ts1...>, tuple_dim<>>> :
-            std::false_type
+        template<typename T1, typename... Ts1, typename T2, typename... Ts2>
+        struct merge<tuple_dim<T1, Ts1...>, tuple_dim<T2, Ts2...>, 1>
+            : prepend<T2, typename merge<tuple_dim<T1, Ts1...>, tuple_dim<Ts2...>>::type>
         {};
 
-        template<typename T2, typename... Ts2>
-        struct is_degenerated<dim_ratio<tuple_dim<>, tuple_dim<T2, Ts2...>>> :
-            std::false_type
+        // sorted power list of arbitrary tags and powers
+        template<typename Tuple>
+        struct sort;
+
+        template<>
+        struct sort<tuple_dim<>>
+        {
+            using type = tuple_dim<>;
+        };
+
+        template<typename T, typename... Ts>
+        struct sort<tuple_dim<T, Ts...>> : merge<tuple_dim<typename as_power<T>::type>, typename sort<tuple_dim<Ts...>>::type>
         {};
 
-        template<typename T1, typename T2>
-        using trim_is_degenerated_v =
-            typename safe_types::internal::is_degenerated<
-                safe_types::internal::dim_ratio<
-                    typename safe_types::internal::trim<T1, T2>::num,
-                    typename safe_types::internal::trim<T1, T2>::den
-            >>::value;
+        // subtracts the exponents of tags present in both sorted power lists
+        template<typename Num, typename Den, int Compare = 2>
+        struct cancel;
+
+        template<typename... Dens, int Compare>
+        struct cancel<tuple_dim<>, tuple_dim<Dens...>, Compare>
+        {
+            using type = dim_ratio<tuple_dim<>, tuple_dim<Dens...>>;
+        };
+
+        template<typename N, typename... Nums, int Compare>
+        struct cancel<tuple_dim<N, Nums...>, tuple_dim<>, Compare>
+        {
+            using type = dim_ratio<tuple_dim<N, Nums...>, tuple_dim<>>;
+        };
+
+        template<typename N, typename... Nums, typename D, typename... Dens>
+        struct cancel<tuple_dim<N, Nums...>, tuple_dim<D, Dens...>, 2>
+            : cancel<tuple_dim<N, Nums...>, tuple_dim<D, Dens...>, power_compare<N, D>()>
+        {};
+
+        template<typename N, typename... Nums, typename D, typename... Dens>
+        struct cancel<tuple_dim<N, Nums...>, tuple_dim<D, Dens...>, 0>
+        {
+            using rest = typename cancel<tuple_dim<Nums...>, tuple_dim<Dens...>>::type;
+            static constexpr int exponent = N::exponent - D::exponent;
+            using type = dim_ratio<
+                typename prepend_power<typename N::tag, (exponent > 0 ? exponent : 0), typename rest::num>::type,
+                typename prepend_power<typename N::tag, (exponent < 0 ? -exponent : 0), typename rest::den>::type>;
+        };
+
+        template<typename N, typename... Nums, typename D, typename... Dens>
+        struct cancel<tuple_dim<N, Nums...>, tuple_dim<D, Dens...>, -1>
+        {
+            using rest = typename cancel<tuple_dim<Nums...>, tuple_dim<D, Dens...>>::type;
+            using type = dim_ratio<typename prepend<N, typename rest::num>::type, typename rest::den>;
+        };
+
+        template<typename N, typename... Nums, typename D, typename... Dens>
+        struct cancel<tuple_dim<N, Nums...>, tuple_dim<D, Dens...>, 1>
+        {
+            using rest = typename cancel<tuple_dim<N, Nums...>, tuple_dim<Dens...>>::type;
+            using type = dim_ratio<typename rest::num, typename prepend<D, typename rest::den>::type>;
+        };
+
+        // canonical form of an arbitrary dim_ratio of tags and powers
+        template<typename DimRatio>
+        using canonical_t = typename cancel<typename sort<typename DimRatio::num>::type, typename sort<typename DimRatio::den>::type>::type;
+
+        template<typename Num, typename Den>
+        using make_dimensions = canonical_t<dim_ratio<Num, Den>>;
+
+        // dimensions of the product and the quotient of two canonical dimensions
+        template<typename Dim1, typename Dim2>
+        using dim_multiply = typename cancel<
+            typename merge<typename Dim1::num, typename Dim2::num>::type,
+            typename merge<typename Dim1::den, typename Dim2::den>::type>::type;
+
+        template<typename Dim1, typename Dim2>
+        using dim_divide = dim_multiply<Dim1, dim_ratio<typename Dim2::den, typename Dim2::num>>;
+
+        // high 64 bits of the unsigned 128-bit product
+        constexpr uint64_t umulhi(uint64_t first, uint64_t second) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(first) * second) >> 64);
+#else
+            const uint64_t a_lo = first & 0xffffffff;
+            const uint64_t a_hi = first >> 32;
+            const uint64_t b_lo = second & 0xffffffff;
+            const uint64_t b_hi = second >> 32;
+            const uint64_t low = a_lo * b_lo;
+            const uint64_t mid1 = a_hi * b_lo + (low >> 32);
+            const uint64_t mid2 = a_lo * b_hi + (mid1 & 0xffffffff);
+            return a_hi * b_hi + (mid1 >> 32) + (mid2 >> 32);
+#endif
+        }
+
+        // high 64 bits of the signed 128-bit product
+        constexpr int64_t mulhi(int64_t first, int64_t second) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            return static_cast<int64_t>((static_cast<__int128>(first) * second) >> 64);
+#else
+            const uint64_t a = static_cast<uint64_t>(first);
+            const uint64_t b = static_cast<uint64_t>(second);
+            return static_cast<int64_t>(umulhi(a, b) - (first < 0 ? b : 0) - (second < 0 ? a : 0));
+#endif
+        }
+
+        struct reciprocal
+        {
+            int64_t multiplier;
+            int shift;
+        };
+
+        // magic multiplier and shift for signed division by Den >= 2 (Hacker's Delight, 10-1);
+        // the construction guarantees the exact truncated quotient for every int64_t dividend
+        constexpr reciprocal signed_reciprocal(int64_t den) noexcept
+        {
+            constexpr uint64_t two63 = uint64_t{ 1 } << 63;
+            const uint64_t ad = static_cast<uint64_t>(den);
+            const uint64_t anc = two63 - 1 - two63 % ad;
+            int p = 63;
+            uint64_t q1 = two63 / anc;
+            uint64_t r1 = two63 - q1 * anc;
+            uint64_t q2 = two63 / ad;
+            uint64_t r2 = two63 - q2 * ad;
+            uint64_t delta = 0;
+            do {
+                ++p;
+                q1 *= 2;
+                r1 *= 2;
+                if (r1 >= anc) {
+                    ++q1;
+                    r1 -= anc;
+                }
+                q2 *= 2;
+                r2 *= 2;
+                if (r2 >= ad) {
+                    ++q2;
+                    r2 -= ad;
+                }
+                delta = ad - r2;
+            } while (q1 < delta || (q1 == delta && r1 == 0));
+            return reciprocal{ static_cast<int64_t>(q2 + 1), p - 64 };
+        }
+
+        template<intmax_t Den>
+        constexpr int64_t divide_by_reciprocal(int64_t value) noexcept
+        {
+            constexpr reciprocal rec = signed_reciprocal(Den);
+            int64_t quotient = mulhi(rec.multiplier, value);
+            quotient += rec.multiplier < 0 ? value : 0;
+            quotient >>= rec.shift;
+            return quotient + static_cast<int64_t>(static_cast<uint64_t>(value) >> 63);
+        }
+
+        template<intmax_t Den>
+        constexpr bool is_power_of_two = Den > 0 && (Den & (Den - 1)) == 0;
+
+        // division by a compile-time denominator: 64-bit signed integers use the precomputed
+        // reciprocal (one multiply-high and shifts instead of a hardware divide), everything
+        // else, including powers of two, is left to the plain operator
+        template<intmax_t Den, typename T>
+        constexpr std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == sizeof(int64_t) && !is_power_of_two<Den>, T>
+            divide_by(T value) noexcept
+        {
+            return static_cast<T>(divide_by_reciprocal<Den>(static_cast<int64_t>(value)));
+        }
+
+        template<intmax_t Den, typename T>
+        constexpr std::enable_if_t<!(std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == sizeof(int64_t) && !is_power_of_two<Den>), T>
+            divide_by(T value) noexcept(noexcept(value / static_cast<T>(Den)))
+        {
+            return value / static_cast<T>(Den);
+        }
+
+        template<intmax_t Num, intmax_t Den, typename T>
+        constexpr T multiply_divide_wide(T value) noexcept
+        {
+            if constexpr (Den <= std::numeric_limits<intmax_t>::max() / Num) {
+                // value = q * Den + r with |r| < Den, so r * Num fits and q * Num only overflows with the result
+                const T quotient = divide_by<Den>(value);
+                const T remainder = value - quotient * static_cast<T>(Den);
+                return quotient * static_cast<T>(Num) + divide_by<Den>(remainder * static_cast<T>(Num));
+            }
+            else {
+#if defined(__SIZEOF_INT128__)
+                return static_cast<T>(static_cast<__int128>(value) * Num / Den);
+#else
+                return divide_by<Den>(value * static_cast<T>(Num));
+#endif
+            }
+        }
+
+        // value * Num / Den; the product is computed in T while it provably fits, either for the whole
+        // range of the source type (decided at compile time) or for the given value (one compare),
+        // and through multiply_divide_wide otherwise
+        template<intmax_t Num, intmax_t Den, typename FromT, typename T>
+        constexpr T multiply_divide(T value) noexcept(noexcept(divide_by<Den>(value * static_cast<T>(Num))))
+        {
+            if constexpr (std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == sizeof(int64_t) && Num > 0) {
+                constexpr T limit = std::numeric_limits<T>::max() / Num;
+                constexpr bool source_fits = std::is_integral<FromT>::value &&
+                    static_cast<uintmax_t>(std::numeric_limits<FromT>::max()) <= static_cast<uintmax_t>(limit) &&
+                    (std::is_unsigned<FromT>::value || static_cast<intmax_t>(std::numeric_limits<FromT>::min()) >= -limit);
+                if (source_fits || (value <= limit && value >= -limit)) {
+                    return divide_by<Den>(value * static_cast<T>(Num));
+                }
+                return multiply_divide_wide<Num, Den>(value);
+            }
+            else {
+                return divide_by<Den>(value * static_cast<T>(Num));
+            }
+        }
 
         template<class ToUT,
             typename RatioFrom,
             typename RatioTo,
             class UT>
             constexpr std::enable_if_t<std::is_convertible_v<UT, intmax_t>, ToUT> cast_value(UT&& value)
+            noexcept(std::is_arithmetic<std::decay_t<UT>>::value && std::is_arithmetic<ToUT>::value)
         {
             using trans_coef = std::ratio_divide<RatioFrom, RatioTo>;
             using common_und_type = std::common_type_t<ToUT, UT, intmax_t>;
@@ -182,8 +472,8 @@ namespace safe_types
                 : trans_coef::num != 1 && trans_coef::den == 1
                 ? static_cast<ToUT>(static_cast<common_und_type>(value) * static_cast<common_und_type>(trans_coef::num))
                 : trans_coef::num == 1 && trans_coef::den != 1
-                ? static_cast<ToUT>(static_cast<common_und_type>(value) / static_cast<common_und_type>(trans_coef::den))
-                : static_cast<ToUT>(static_cast<common_und_type>(value) * static_cast<common_und_type>(trans_coef::num) / static_cast<common_und_type>(trans_coef::den))
+                ? static_cast<ToUT>(divide_by<trans_coef::den>(static_cast<common_und_type>(value)))
+                : static_cast<ToUT>(multiply_divide<trans_coef::num, trans_coef::den, std::decay_t<UT>>(static_cast<common_und_type>(value)))
                 );
         }
 
@@ -192,10 +482,150 @@ namespace safe_types
             typename RatioTo,
             class UT>
             constexpr std::enable_if_t<!std::is_convertible_v<UT, intmax_t>, ToUT> cast_value(UT&& value)
+            noexcept(std::is_nothrow_constructible<ToUT, UT&&>::value)
         {
             return static_cast<ToUT>(std::move(value));
         }
 
+        // whether cast_value<ToUT, RatioFrom, RatioTo>(value) is representable in ToUT, for arithmetic
+        // types; the product is formed as cast_value forms it, exactly for integers where 128-bit
+        // arithmetic is available
+        template<class ToUT,
+            typename RatioFrom,
+            typename RatioTo,
+            class UT>
+            constexpr bool cast_fits(UT value) noexcept
+        {
+            using trans_coef = std::ratio_divide<RatioFrom, RatioTo>;
+            if constexpr (std::is_integral<UT>::value && std::is_integral<ToUT>::value) {
+#if defined(__SIZEOF_INT128__)
+                const __int128 result = static_cast<__int128>(value) * trans_coef::num / trans_coef::den;
+                return result >= static_cast<__int128>(std::numeric_limits<ToUT>::min()) && result <= static_cast<__int128>(std::numeric_limits<ToUT>::max());
+#else
+                const long double result = static_cast<long double>(value) * trans_coef::num / trans_coef::den;
+                return result >= static_cast<long double>(std::numeric_limits<ToUT>::min()) && result <= static_cast<long double>(std::numeric_limits<ToUT>::max());
+#endif
+            }
+            else {
+                using common_und_type = std::common_type_t<ToUT, UT, intmax_t>;
+                const common_und_type result = static_cast<common_und_type>(value) * static_cast<common_und_type>(trans_coef::num) / static_cast<common_und_type>(trans_coef::den);
+                if constexpr (std::is_floating_point<ToUT>::value) {
+                    constexpr common_und_type max = static_cast<common_und_type>(std::numeric_limits<ToUT>::max());
+                    return result != result || (result >= -max && result <= max);
+                }
+                else {
+                    // conversion truncates toward zero, so everything strictly between min - 1 and max + 1 fits
+                    return result > static_cast<common_und_type>(std::numeric_limits<ToUT>::min()) - 1 &&
+                        result < static_cast<common_und_type>(std::numeric_limits<ToUT>::max()) + 1;
+                }
+            }
+        }
+
+        // value in the common representation, passed through by reference when no conversion is needed
+        // (comparisons of heavy underlying types such as std::string must not copy)
+        template<class CommonUT,
+            typename RatioFrom,
+            typename CommonRatio,
+            class UT>
+            constexpr decltype(auto) common_value(const UT& value)
+            noexcept((std::is_same<CommonUT, UT>::value && std::ratio_equal<RatioFrom, CommonRatio>::value) || noexcept(cast_value<CommonUT, RatioFrom, CommonRatio>(value)))
+        {
+            if constexpr (std::is_same<CommonUT, UT>::value && std::ratio_equal<RatioFrom, CommonRatio>::value) {
+                return (value);
+            }
+            else {
+                return cast_value<CommonUT, RatioFrom, CommonRatio>(value);
+            }
+        }
+
+        // arithmetic modulo the Mersenne prime 2^61 - 1, where every ratio denominator is invertible
+        constexpr uint64_t mersenne61 = (uint64_t{ 1 } << 61) - 1;
+
+        constexpr uint64_t mod_mersenne61(uint64_t value) noexcept
+        {
+            value = (value & mersenne61) + (value >> 61);
+            return value >= mersenne61 ? value - mersenne61 : value;
+        }
+
+        // both factors are below 2^61
+        constexpr uint64_t mul_mersenne61(uint64_t first, uint64_t second) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            const auto product = static_cast<unsigned __int128>(first) * second;
+            return mod_mersenne61((static_cast<uint64_t>(product) & mersenne61) + static_cast<uint64_t>(product >> 61));
+#else
+            const uint64_t low = first * second;
+            return mod_mersenne61((low & mersenne61) + ((umulhi(first, second) << 3) | (low >> 61)));
+#endif
+        }
+
+        constexpr uint64_t pow_mersenne61(uint64_t base, uint64_t exponent) noexcept
+        {
+            uint64_t result = 1;
+            for (; exponent != 0; exponent >>= 1) {
+                if (exponent & 1) {
+                    result = mul_mersenne61(result, base);
+                }
+                base = mul_mersenne61(base, base);
+            }
+            return result;
+        }
+
+        template<typename T>
+        constexpr uint64_t residue_mersenne61(T value) noexcept
+        {
+            if constexpr (std::is_signed<T>::value) {
+                if (value < 0) {
+                    const uint64_t residue = mod_mersenne61(0 - static_cast<uint64_t>(value));
+                    return residue == 0 ? 0 : mersenne61 - residue;
+                }
+            }
+            return mod_mersenne61(static_cast<uint64_t>(value));
+        }
+
+        // Num / Den as an element of the field, i.e. Num * Den^(p - 2)
+        template<typename Ratio>
+        constexpr uint64_t ratio_mersenne61 = mul_mersenne61(
+            residue_mersenne61(Ratio::num),
+            pow_mersenne61(residue_mersenne61(Ratio::den), mersenne61 - 2));
+
+        constexpr intmax_t half_mersenne61 = static_cast<intmax_t>(mersenne61 / 2);
+
+        // hash of the value in base units, so that quantities equal through operator== hash equally
+        // whatever their ratio and underlying type; used by the transparent safe_types::hash<>, as
+        // std::hash of a quantity only meets keys of its own type and hashes the plain value. An integral value is the fraction value * Num / Den
+        // taken modulo 2^61 - 1 (one constant multiply, no division) and mapped to the symmetric range,
+        // which leaves every value of a ratio 1 type below 2^60 as it is; such values skip the
+        // reduction. Floating point values are scaled to the base unit and hash equally up to the
+        // rounding of that scaling; other types hash as they are.
+        template<typename Ratio, typename UT>
+        size_t normalized_hash(const UT& value) noexcept(noexcept(std::hash<UT>{}(value)))
+        {
+            if constexpr (std::is_integral<UT>::value) {
+                if constexpr (std::ratio_equal<Ratio, std::ratio<1>>::value) {
+                    if constexpr (sizeof(UT) < sizeof(uint64_t)) {
+                        return std::hash<intmax_t>{}(static_cast<intmax_t>(value));
+                    }
+                    else if constexpr (std::is_signed<UT>::value) {
+                        if (value >= -half_mersenne61 && value <= half_mersenne61) {
+                            return std::hash<intmax_t>{}(static_cast<intmax_t>(value));
+                        }
+                    }
+                    else if (value <= static_cast<uint64_t>(half_mersenne61)) {
+                        return std::hash<intmax_t>{}(static_cast<intmax_t>(value));
+                    }
+                }
+                const uint64_t residue = mul_mersenne61(residue_mersenne61(value), ratio_mersenne61<Ratio>);
+                const intmax_t canonical = residue > mersenne61 / 2 ? static_cast<intmax_t>(residue) - static_cast<intmax_t>(mersenne61) : static_cast<intmax_t>(residue);
+                return std::hash<intmax_t>{}(canonical);
+            }
+            else if constexpr (std::is_floating_point<UT>::value && !std::ratio_equal<Ratio, std::ratio<1>>::value) {
+                return std::hash<UT>{}(cast_value<UT, Ratio, std::ratio<1>>(value));
+            }
+            else {
+                return std::hash<UT>{}(value);
+            }
+        }
     }
 
     template<typename T1, typename T2>
@@ -209,26 +639,9 @@ namespace safe_types
         safe_types::internal::dim_ratio<
         safe_types::internal::tuple_dim<Num2...>,
         safe_types::internal::tuple_dim<Den2...>>>
-        : std::conditional_t<
-        safe_types::internal::is_degenerated<
-        safe_types::internal::dim_ratio<
-        typename safe_types::internal::trim<
-        typename safe_types::internal::join<
-        safe_types::internal::tuple_dim<Num1...>,
-        safe_types::internal::tuple_dim<Den2...>>::type,
-        typename safe_types::internal::join<
-        safe_types::internal::tuple_dim<Num2...>,
-        safe_types::internal::tuple_dim<Den1...>>::type>::num,
-        typename safe_types::internal::trim<
-        typename safe_types::internal::join<
-        safe_types::internal::tuple_dim<Num1...>,
-        safe_types::internal::tuple_dim<Den2...>>::type,
-        typename safe_types::internal::join<
-        safe_types::internal::tuple_dim<Num2...>,
-        safe_types::internal::tuple_dim<Den1...>>::type>::den
-        >>::value,
-        std::true_type,
-        std::false_type>
+        : std::is_same<
+        safe_types::internal::make_dimensions<safe_types::internal::tuple_dim<Num1...>, safe_types::internal::tuple_dim<Den1...>>,
+        safe_types::internal::make_dimensions<safe_types::internal::tuple_dim<Num2...>, safe_types::internal::tuple_dim<Den2...>>>
     {};
 }
 
@@ -236,21 +649,75 @@ namespace safe_types
 {
     namespace internal
     {
+        // dimensions of complex types are canonical, so equal dimensions are the same type
         template<typename Dim1, typename Dim2>
-        using DimIsConvertible = std::enable_if_t<is_same<Dim1, Dim2>::value>;
+        using DimIsConvertible = std::enable_if_t<std::is_same<Dim1, Dim2>::value>;
     }
 
-    template<typename UnderlyingType, typename Ratio, typename DimRatio, typename Limitations = limitations<true, true, true>>
-    class complex_type {};
+    // Hash policies turn std::hash of a value (or, for safe_types::hash<>, internal::normalized_hash,
+    // equal for equal quantities of any ratio) into the hash of a type with the dimensions Dim.
+    // identity_hash keeps it, which is the identity for integers in common standard libraries; the
+    // others spread consecutive or strided keys over the low bits that open-addressing tables mask with.
+    struct identity_hash
+    {
+        template<typename Dim>
+        static constexpr size_t mix(size_t hash) noexcept
+        {
+            return hash;
+        }
+    };
+
+    // Fibonacci hashing: one multiply, with the well-mixed high half folded into the low bits
+    struct multiplicative_hash
+    {
+        template<typename Dim>
+        static constexpr size_t mix(size_t hash) noexcept
+        {
+            const uint64_t product = static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+            return static_cast<size_t>(product ^ (product >> 32));
+        }
+    };
+
+    // wyhash64 of the hash with itself: two rounds of the 128-bit multiply-fold mixer
+    struct wy_hash
+    {
+        template<typename Dim>
+        static constexpr size_t mix(size_t hash) noexcept
+        {
+            constexpr uint64_t secret0 = 0xa0761d6478bd642full;
+            constexpr uint64_t secret1 = 0xe7037ed1a0b428dbull;
+            const uint64_t first = static_cast<uint64_t>(hash) ^ secret0;
+            const uint64_t second = static_cast<uint64_t>(hash) ^ secret1;
+            const uint64_t low = (first * second) ^ secret0;
+            const uint64_t high = internal::umulhi(first, second) ^ secret1;
+            return static_cast<size_t>((low * high) ^ internal::umulhi(low, high));
+        }
+    };
 
-    template<bool arithmetic, bool ordering, bool stream>
+    // Policy seeded with a key of the dimensions, so tables of different ID dimensions
+    // holding the same raw values do not probe in the same order
+    template<typename Policy = wy_hash>
+    struct salted_hash
+    {
+        template<typename Dim>
+        static constexpr size_t mix(size_t hash) noexcept
+        {
+            return Policy::template mix<Dim>(hash ^ static_cast<size_t>(internal::type_key<Dim>));
+        }
+    };
+
+    template<bool arithmetic, bool ordering, bool stream, typename HashPolicy = identity_hash>
     struct limitations
     {
         static constexpr bool enableArithmetic = arithmetic;
         static constexpr bool enableOrdering = ordering;
         static constexpr bool enableStream = stream;
+        using hash_policy = HashPolicy;
     };
 
+    template<typename UnderlyingType, typename Ratio, typename DimRatio, typename Limitations = limitations<true, true, true>>
+    class complex_type {};
+
     namespace internal
     {
         template<typename Lim1, typename Lim2 = Lim1>
@@ -272,143 +739,140 @@ namespace safe_types
         using dimensions = internal::dim_ratio<internal::tuple_dim<DimNums...>, internal::tuple_dim<DimDens...>>;
         using limitations = Limitations;
 
-        constexpr UnderlyingType value() const noexcept
+        static_assert(std::is_same<dimensions, internal::canonical_t<dimensions>>::value,
+            "dimensions must be canonical: build them with internal::make_dimensions or from simple_type products");
+
+        constexpr const UnderlyingType& value() const& noexcept
         {
             return m_value;
         }
 
-        template<typename = std::enable_if<std::is_default_constructible<typename underlying_type>::value>::type>
-        constexpr complex_type()
+        constexpr UnderlyingType value() && noexcept(std::is_nothrow_move_constructible<UnderlyingType>::value)
+        {
+            return std::move(m_value);
+        }
+
+        template<typename = std::enable_if_t<std::is_default_constructible<UnderlyingType>::value>>
+        constexpr complex_type() noexcept(std::is_nothrow_default_constructible<UnderlyingType>::value)
             : m_value {}
         {
         }
 
-        explicit constexpr complex_type(internal::parameter_for_copy_t<UnderlyingType> value)
+        explicit constexpr complex_type(internal::parameter_for_copy_t<UnderlyingType> value) noexcept(std::is_nothrow_copy_constructible<UnderlyingType>::value)
             : m_value{ value }
         {
         }
 
         template<typename = internal::enable_if_not_arithmetic<UnderlyingType>>
-        explicit constexpr complex_type(UnderlyingType&& value)
+        explicit constexpr complex_type(UnderlyingType&& value) noexcept(std::is_nothrow_move_constructible<UnderlyingType>::value)
             : m_value{ std::move(value) }
         {
         }
 
-        template<typename UnderlyingType, intmax_t Num, intmax_t Den, typename ... DimNums, typename ... DimDens, 
-            typename = internal::DimIsConvertible<internal::dim_ratio<internal::tuple_dim<DimNums...>, internal::tuple_dim<DimDens...>>, dimensions>>
-        constexpr complex_type(const complex_type<UnderlyingType, std::ratio<Num, Den>, internal::dim_ratio<internal::tuple_dim<DimNums...>, internal::tuple_dim<DimDens...>>>& other)
-            : m_value{ internal::cast_value<underlying_type, std::ratio<Num, Den>, period>(other.value()) }
-        {
-        }
-
-        template<typename UnderlyingType, intmax_t Num, intmax_t Den, typename ... DimNums, typename ... DimDens,
-            typename = internal::DimIsConvertible<internal::dim_ratio<internal::tuple_dim<DimNums...>, internal::tuple_dim<DimDens...>>, dimensions>>
-            constexpr complex_type& operator=(const complex_type<UnderlyingType, std::ratio<Num, Den>, internal::dim_ratio<internal::tuple_dim<DimNums...>, internal::tuple_dim<DimDens...>>>& other)
+        template<typename OtherUnderlyingType, intmax_t OtherNum, intmax_t OtherDen, typename ... OtherDimNums, typename ... OtherDimDens,
+            typename = internal::DimIsConvertible<internal::dim_ratio<internal::tuple_dim<OtherDimNums...>, internal::tuple_dim<OtherDimDens...>>, dimensions>>
+        constexpr complex_type(const complex_type<OtherUnderlyingType, std::ratio<OtherNum, OtherDen>, internal::dim_ratio<internal::tuple_dim<OtherDimNums...>, internal::tuple_dim<OtherDimDens...>>>& other)
+            noexcept(noexcept(internal::cast_value<underlying_type, std::ratio<OtherNum, OtherDen>, period>(other.value())))
+            : m_value{ internal::cast_value<underlying_type, std::ratio<OtherNum, OtherDen>, period>(other.value()) }
         {
-            m_value = internal::cast_value<underlying_type, std::ratio<Num, Den>, period>(other.value());
         }
 
-        constexpr complex_type(const complex_type& other)
-            : m_value{other.m_value}
+        template<typename OtherUnderlyingType, intmax_t OtherNum, intmax_t OtherDen, typename ... OtherDimNums, typename ... OtherDimDens,
+            typename = internal::DimIsConvertible<internal::dim_ratio<internal::tuple_dim<OtherDimNums...>, internal::tuple_dim<OtherDimDens...>>, dimensions>>
+            constexpr complex_type& operator=(const complex_type<OtherUnderlyingType, std::ratio<OtherNum, OtherDen>, internal::dim_ratio<internal::tuple_dim<OtherDimNums...>, internal::tuple_dim<OtherDimDens...>>>& other)
+            noexcept(noexcept(internal::cast_value<underlying_type, std::ratio<OtherNum, OtherDen>, period>(other.value())) && std::is_nothrow_move_assignable<UnderlyingType>::value)
         {
-        }
-
-        constexpr complex_type& operator=(const complex_type& other)
-        {
-            m_value = other.m_value;
+            m_value = internal::cast_value<underlying_type, std::ratio<OtherNum, OtherDen>, period>(other.value());
             return *this;
         }
 
-        constexpr complex_type(complex_type&& other)
-            : m_value{ std::move(other.m_value) }
-        {
-        }
+        // defaulted so that complex_type is trivially copyable whenever UnderlyingType is
+        // (std::copy, std::vector and memcpy take the same path as for the raw type)
+        // and inherits the noexcept of UnderlyingType, so std::vector moves on reallocation
+        constexpr complex_type(const complex_type& other) = default;
+        constexpr complex_type& operator=(const complex_type& other) = default;
+        constexpr complex_type(complex_type&& other) = default;
+        constexpr complex_type& operator=(complex_type&& other) = default;
 
-        constexpr complex_type& operator=(complex_type&& other)
-        {
-            m_value = std::move(other.m_value);
-            return *this;
-        }
-
-        constexpr complex_type operator+() const
+        constexpr complex_type operator+() const noexcept(internal::is_nothrow_value_v<UnderlyingType>)
         {
             return complex_type{ value() };
         }
 
-        constexpr complex_type operator-() const
+        constexpr complex_type operator-() const noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(-std::declval<const UnderlyingType&>()))
         {
             return complex_type{ -value() };
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator++()
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator++() noexcept(noexcept(++std::declval<UnderlyingType&>()))
         {
             ++m_value;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type operator++(int)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type operator++(int) noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>()++))
         {
             return (complex_type(m_value++));
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator--()
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator--() noexcept(noexcept(--std::declval<UnderlyingType&>()))
         {
             --m_value;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type operator--(int)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type operator--(int) noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>()--))
         {
             return (complex_type(m_value--));
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator+=(const complex_type& right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator+=(const complex_type& right) noexcept(noexcept(std::declval<UnderlyingType&>() += std::declval<const UnderlyingType&>()))
         {
             m_value += right.m_value;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator-=(const complex_type& right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator-=(const complex_type& right) noexcept(noexcept(std::declval<UnderlyingType&>() -= std::declval<const UnderlyingType&>()))
         {
             m_value -= right.m_value;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator*=(internal::parameter_for_copy_t<UnderlyingType> right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator*=(internal::parameter_for_copy_t<UnderlyingType> right) noexcept(noexcept(std::declval<UnderlyingType&>() *= std::declval<const UnderlyingType&>()))
         {
             m_value *= right;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator/=(internal::parameter_for_copy_t<UnderlyingType> right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator/=(internal::parameter_for_copy_t<UnderlyingType> right) noexcept(noexcept(std::declval<UnderlyingType&>() /= std::declval<const UnderlyingType&>()))
         {
             m_value /= right;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator%=(internal::parameter_for_copy_t<UnderlyingType> right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator%=(internal::parameter_for_copy_t<UnderlyingType> right) noexcept(noexcept(std::declval<UnderlyingType&>() %= std::declval<const UnderlyingType&>()))
         {
             m_value %= right;
             return (*this);
         }
 
-        template<typename = internal::arithmetic_enabled<limitations>>
-        constexpr complex_type& operator%=(const complex_type& right)
+        template<typename Lim = limitations, typename = internal::arithmetic_enabled<Lim>>
+        constexpr complex_type& operator%=(const complex_type& right) noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>() %= std::declval<const UnderlyingType&>()))
         {
             m_value %= right.value();
             return (*this);
         }
 
-        template<typename Stream, typename = internal::streaming_enabled<limitations>>
+        template<typename Stream, typename Lim = limitations, typename = internal::streaming_enabled<Lim>>
         friend Stream& operator <<(Stream& stream, const complex_type& ct)
         {
             return stream << ct.value();
@@ -424,23 +888,41 @@ namespace safe_types
         struct _is_complex_type : std::false_type
         {};
 
-        template<typename UT, typename Ratio, typename DimRatio>
-        struct _is_complex_type<complex_type<UT, Ratio, DimRatio>> : std::true_type
+        template<typename UT, typename Ratio, typename DimRatio, typename Lim>
+        struct _is_complex_type<complex_type<UT, Ratio, DimRatio, Lim>> : std::true_type
         {};
 
+        template<typename T>
+        using enable_if_not_complex = std::enable_if_t<!_is_complex_type<std::decay_t<T>>::value>;
+
         template<typename CT, typename T>
         using _enable_if_is_complex = typename std::enable_if<_is_complex_type<CT>::value, T>::type;
     }
 
-    template<typename UnderlyingType, typename Ratio, typename DimType>
-    using simple_type = complex_type<UnderlyingType, Ratio, internal::dim_ratio<internal::tuple_dim<DimType>, internal::tuple_dim<>>>;
+    template<typename UnderlyingType, typename Ratio, typename DimType, typename Limitations = limitations<true, true, true>>
+    using simple_type = complex_type<UnderlyingType, Ratio, internal::dim_ratio<internal::tuple_dim<internal::dim_power<DimType, 1>>, internal::tuple_dim<>>, Limitations>;
 
-    template<typename UnderlyingType, typename DimType>
-    using singleton = simple_type<UnderlyingType, std::ratio<1>, DimType>;
+    template<typename UnderlyingType, typename DimType, typename Limitations = limitations<true, true, true>>
+    using singleton = simple_type<UnderlyingType, std::ratio<1>, DimType, Limitations>;
 
     template<typename Ratio1, typename Ratio2>
     using common_ratio = std::ratio<internal::gcd(Ratio1::num, Ratio2::num), internal::lcm(Ratio1::den, Ratio2::den)>;
 
+    namespace internal
+    {
+        // whether comparing the values of two units in their common representation may throw: only
+        // the comparison itself and the conversion of an operand whose representation changes count
+        template<typename UT1, typename Ratio1, typename UT2, typename Ratio2>
+        constexpr bool is_nothrow_equality_v = noexcept(
+            common_value<std::common_type_t<UT1, UT2>, Ratio1, safe_types::common_ratio<Ratio1, Ratio2>>(std::declval<const UT1&>()) ==
+            common_value<std::common_type_t<UT1, UT2>, Ratio2, safe_types::common_ratio<Ratio1, Ratio2>>(std::declval<const UT2&>()));
+
+        template<typename UT1, typename Ratio1, typename UT2, typename Ratio2>
+        constexpr bool is_nothrow_ordering_v = noexcept(
+            common_value<std::common_type_t<UT1, UT2>, Ratio1, safe_types::common_ratio<Ratio1, Ratio2>>(std::declval<const UT1&>()) <
+            common_value<std::common_type_t<UT1, UT2>, Ratio2, safe_types::common_ratio<Ratio1, Ratio2>>(std::declval<const UT2&>()));
+    }
+
 }
 
 namespace std
@@ -458,12 +940,14 @@ namespace std
         using type = safe_types::complex_type<common_type_t<Und1, Und2>, safe_types::common_ratio<Ratio1, Ratio2>, Dim1>;
     };
 
-    template<typename UnderlyingType, typename Ratio, typename Dim>
-    struct hash< safe_types::complex_type<UnderlyingType, Ratio, Dim> >
+    // the hash policy applied to std::hash of the value; safe_types::hash<> hashes across ratios
+    template<typename UnderlyingType, typename Ratio, typename Dim, typename Lim>
+    struct hash< safe_types::complex_type<UnderlyingType, Ratio, Dim, Lim> >
     {
-        size_t operator() (const safe_types::complex_type<UnderlyingType, Ratio, Dim>& ct) const noexcept
+        size_t operator() (const safe_types::complex_type<UnderlyingType, Ratio, Dim, Lim>& ct) const
+            noexcept(noexcept(std::hash<UnderlyingType>{}(ct.value())))
         {
-            return std::hash<UnderlyingType>{}(ct.value());
+            return Lim::hash_policy::template mix<Dim>(std::hash<UnderlyingType>{}(ct.value()));
         }
     };
 }
@@ -487,13 +971,16 @@ namespace safe_types
         typename Ratio2,
         typename Dim1,
         typename Dim2,
+        typename Lim1,
+        typename Lim2,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
         constexpr bool
-        operator==(const complex_type<FirstUnderlyingType, Ratio1, Dim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2>& second) noexcept
+        operator==(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_equality_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         using common_ut = std::common_type_t<FirstUnderlyingType, SecondUnderlyingType>;
         using common_ratio = safe_types::common_ratio<Ratio1, Ratio2>;
-        return internal::cast_value<common_ut, Ratio1, common_ratio>(first.value()) == internal::cast_value<common_ut, Ratio2, common_ratio>(second.value());
+        return internal::common_value<common_ut, Ratio1, common_ratio>(first.value()) == internal::common_value<common_ut, Ratio2, common_ratio>(second.value());
     }
 
     template<typename FirstUnderlyingType,
@@ -502,9 +989,12 @@ namespace safe_types
         typename Ratio2,
         typename Dim1,
         typename Dim2,
+        typename Lim1,
+        typename Lim2,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
         constexpr bool
-        operator!=(const complex_type<FirstUnderlyingType, Ratio1, Dim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2>& second) noexcept
+        operator!=(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_equality_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         return !(first == second);
     }
@@ -519,11 +1009,12 @@ namespace safe_types
         typename Lim2,
         typename = internal::ordering_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr bool operator<(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr bool operator<(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_ordering_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         using common_ut = std::common_type_t<FirstUnderlyingType, SecondUnderlyingType>;
         using common_ratio = safe_types::common_ratio<Ratio1, Ratio2>;
-        return internal::cast_value<common_ut, Ratio1, common_ratio>(first.value()) < internal::cast_value<common_ut, Ratio2, common_ratio>(second.value());
+        return internal::common_value<common_ut, Ratio1, common_ratio>(first.value()) < internal::common_value<common_ut, Ratio2, common_ratio>(second.value());
     }
 
     template<typename FirstUnderlyingType,
@@ -536,7 +1027,8 @@ namespace safe_types
         typename Lim2,
         typename = internal::ordering_enabled<Lim1, Lim2>,
         typename = safe_types::internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr bool operator>(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr bool operator>(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_ordering_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         return second < first;
     }
@@ -551,7 +1043,8 @@ namespace safe_types
         typename Lim2,
         typename = internal::ordering_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr bool operator<=(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr bool operator<=(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_ordering_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         return !(second < first);
     }
@@ -566,7 +1059,8 @@ namespace safe_types
         typename Lim2,
         typename = internal::ordering_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr bool operator>=(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr bool operator>=(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_ordering_v<FirstUnderlyingType, Ratio1, SecondUnderlyingType, Ratio2>)
     {
         return !(first < second);
     }
@@ -581,12 +1075,26 @@ namespace safe_types
         typename Lim2,
         typename = internal::arithmetic_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr auto operator+(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr auto operator+(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_operands_v<FirstUnderlyingType, SecondUnderlyingType> && noexcept(std::declval<FirstUnderlyingType>() + std::declval<SecondUnderlyingType>()))
     {
         using _CT = std::common_type_t<complex_type<FirstUnderlyingType, Ratio1, Dim1>, complex_type<SecondUnderlyingType, Ratio2, Dim2>>;
         return _CT(cast<_CT>(first).value() + cast<_CT>(second).value());
     }
 
+    template<typename UnderlyingType,
+        typename Ratio,
+        typename Dim,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>>
+        constexpr auto operator+(complex_type<UnderlyingType, Ratio, Dim, Lim>&& first, const complex_type<UnderlyingType, Ratio, Dim, Lim>& second)
+        noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>() += std::declval<const UnderlyingType&>()))
+    {
+        using _CT = std::common_type_t<complex_type<UnderlyingType, Ratio, Dim>, complex_type<UnderlyingType, Ratio, Dim>>;
+        first += second;
+        return _CT(std::move(first).value());
+    }
+
     template<typename FirstUnderlyingType,
         typename SecondUnderlyingType,
         typename Ratio1,
@@ -597,9 +1105,24 @@ namespace safe_types
         typename Lim2,
         typename = internal::arithmetic_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr auto operator-(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr auto operator-(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_operands_v<FirstUnderlyingType, SecondUnderlyingType> && noexcept(std::declval<FirstUnderlyingType>() - std::declval<SecondUnderlyingType>()))
     {
-        return first + (-second);
+        using _CT = std::common_type_t<complex_type<FirstUnderlyingType, Ratio1, Dim1>, complex_type<SecondUnderlyingType, Ratio2, Dim2>>;
+        return _CT(cast<_CT>(first).value() - cast<_CT>(second).value());
+    }
+
+    template<typename UnderlyingType,
+        typename Ratio,
+        typename Dim,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>>
+        constexpr auto operator-(complex_type<UnderlyingType, Ratio, Dim, Lim>&& first, const complex_type<UnderlyingType, Ratio, Dim, Lim>& second)
+        noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>() -= std::declval<const UnderlyingType&>()))
+    {
+        using _CT = std::common_type_t<complex_type<UnderlyingType, Ratio, Dim>, complex_type<UnderlyingType, Ratio, Dim>>;
+        first -= second;
+        return _CT(std::move(first).value());
     }
 
     template<typename FirstUnderlyingType,
@@ -611,9 +1134,10 @@ namespace safe_types
         typename Lim1,
         typename Lim2,
         typename = internal::arithmetic_enabled<Lim1, Lim2>>
-        constexpr auto operator*(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr auto operator*(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_operands_v<FirstUnderlyingType, SecondUnderlyingType> && noexcept(std::declval<FirstUnderlyingType>() * std::declval<SecondUnderlyingType>()))
     {
-        using common_dim_type = internal::trim<typename internal::join<typename Dim1::num, typename Dim2::num>::type, typename internal::join<typename Dim1::den, typename Dim2::den>::type>;
+        using common_dim_type = internal::dim_multiply<Dim1, Dim2>;
         constexpr auto gcd12 = internal::gcd(Ratio1::num, Ratio2::den);
         constexpr auto gcd21 = internal::gcd(Ratio2::num, Ratio1::den);
         using common_ratio = std::ratio<
@@ -621,9 +1145,9 @@ namespace safe_types
             Ratio1::den / gcd21 * Ratio2::den / gcd12 >;
         using common_underlying = std::common_type_t<FirstUnderlyingType, SecondUnderlyingType>;
         using common = std::conditional_t <
-            internal::is_degenerated<internal::dim_ratio<typename common_dim_type::num, typename common_dim_type::den>>::value,
+            internal::is_degenerated<common_dim_type>::value,
             common_underlying,
-            complex_type<common_underlying, common_ratio, internal::dim_ratio<typename common_dim_type::num, typename common_dim_type::den>>>;
+            complex_type<common_underlying, common_ratio, common_dim_type>>;
         return common{ first.value() * second.value() };
     }
 
@@ -633,19 +1157,35 @@ namespace safe_types
         typename T,
         typename Lim,
         typename = internal::arithmetic_enabled<Lim>>
-        constexpr auto operator*(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val) noexcept
+        constexpr auto operator*(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() * std::declval<T>()))
     {
         using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
         return type{ first.value() * val };
     }
 
+    template<typename UnderlyingType,
+        typename Ratio1,
+        typename Dim,
+        typename T,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>,
+        typename = internal::enable_if_not_complex<T>>
+        constexpr auto operator*(complex_type<UnderlyingType, Ratio1, Dim, Lim>&& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() * std::declval<T>()))
+    {
+        using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
+        return type{ std::move(first).value() * val };
+    }
+
     template<typename UnderlyingType,
         typename Ratio1,
         typename Dim,
         typename T,
         typename Lim,
         typename = internal::arithmetic_enabled<Lim>>
-        constexpr auto operator*(const T& val, const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first) noexcept
+        constexpr auto operator*(const T& val, const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() * std::declval<T>()))
     {
         using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
         return type{ first.value() * val };
@@ -657,21 +1197,37 @@ namespace safe_types
         typename T,
         typename Lim,
         typename = internal::arithmetic_enabled<Lim>>
-        constexpr auto operator/(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val) noexcept
+        constexpr auto operator/(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() / std::declval<T>()))
     {
         using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
         return type{ first.value() / val };
     }
 
+    template<typename UnderlyingType,
+        typename Ratio1,
+        typename Dim,
+        typename T,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>,
+        typename = internal::enable_if_not_complex<T>>
+        constexpr auto operator/(complex_type<UnderlyingType, Ratio1, Dim, Lim>&& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() / std::declval<T>()))
+    {
+        using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
+        return type{ std::move(first).value() / val };
+    }
+
     template<typename UnderlyingType,
         typename Ratio1,
         typename Dim,
         typename T,
         typename Lim,
         typename = internal::arithmetic_enabled<Lim>>
-        constexpr auto operator/(const T& val, const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first) noexcept
+        constexpr auto operator/(const T& val, const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<T>() / std::declval<UnderlyingType>()))
     {
-        using type = complex_type<std::common_type_t<UnderlyingType, T>, std::ratio<Ratio1::den, Ratio1::num>, internal::dim_ratio<Dim::den, Dim::num>>;
+        using type = complex_type<std::common_type_t<UnderlyingType, T>, std::ratio<Ratio1::den, Ratio1::num>, internal::dim_ratio<typename Dim::den, typename Dim::num>>;
         return type{ val / first.value() };
     }
 
@@ -684,9 +1240,10 @@ namespace safe_types
         typename Lim1,
         typename Lim2,
         typename = internal::arithmetic_enabled<Lim1, Lim2>>
-        constexpr auto operator/(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr auto operator/(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_operands_v<FirstUnderlyingType, SecondUnderlyingType> && noexcept(std::declval<FirstUnderlyingType>() / std::declval<SecondUnderlyingType>()))
     {
-        using common_dim_type = internal::trim<typename internal::join<typename Dim1::num, typename Dim2::den>::type, typename internal::join<typename Dim1::den, typename Dim2::num>::type>;
+        using common_dim_type = internal::dim_divide<Dim1, Dim2>;
         constexpr auto gcd_num = internal::gcd(Ratio1::num, Ratio2::num);
         constexpr auto gcd_den = internal::gcd(Ratio2::den, Ratio1::den);
         using common_ratio = std::ratio<
@@ -694,9 +1251,9 @@ namespace safe_types
             Ratio1::den / gcd_den * Ratio2::num / gcd_num >;
         using common_underlying = std::common_type_t<FirstUnderlyingType, SecondUnderlyingType>;
         using common = std::conditional_t <
-            internal::is_degenerated<internal::dim_ratio<typename common_dim_type::num, typename common_dim_type::den>>::value,
+            internal::is_degenerated<common_dim_type>::value,
             common_underlying,
-            complex_type<common_underlying, common_ratio, internal::dim_ratio<typename common_dim_type::num, typename common_dim_type::den>>>;
+            complex_type<common_underlying, common_ratio, common_dim_type>>;
         return common{ first.value() / second.value() };
     }
 
@@ -706,12 +1263,27 @@ namespace safe_types
         typename T,
         typename Lim,
         typename = internal::arithmetic_enabled<Lim>>
-        constexpr auto operator%(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val) noexcept
+        constexpr auto operator%(const complex_type<UnderlyingType, Ratio1, Dim, Lim>& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() % std::declval<T>()))
     {
         using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
         return type{ first.value() % val };
     }
 
+    template<typename UnderlyingType,
+        typename Ratio1,
+        typename Dim,
+        typename T,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>,
+        typename = internal::enable_if_not_complex<T>>
+        constexpr auto operator%(complex_type<UnderlyingType, Ratio1, Dim, Lim>&& first, const T& val)
+        noexcept(internal::is_nothrow_operands_v<UnderlyingType, T> && noexcept(std::declval<UnderlyingType>() % std::declval<T>()))
+    {
+        using type = complex_type<std::common_type_t<UnderlyingType, T>, Ratio1, Dim>;
+        return type{ std::move(first).value() % val };
+    }
+
     template<typename FirstUnderlyingType,
         typename SecondUnderlyingType,
         typename Ratio1,
@@ -722,11 +1294,25 @@ namespace safe_types
         typename Lim2,
         typename = internal::arithmetic_enabled<Lim1, Lim2>,
         typename = internal::DimIsConvertible<Dim1, Dim2>>
-        constexpr auto operator%(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second) noexcept
+        constexpr auto operator%(const complex_type<FirstUnderlyingType, Ratio1, Dim1, Lim1>& first, const complex_type<SecondUnderlyingType, Ratio2, Dim2, Lim2>& second)
+        noexcept(internal::is_nothrow_operands_v<FirstUnderlyingType, SecondUnderlyingType> && noexcept(std::declval<FirstUnderlyingType>() % std::declval<SecondUnderlyingType>()))
     {
         using _CT = std::common_type_t<complex_type<FirstUnderlyingType, Ratio1, Dim1>, complex_type<SecondUnderlyingType, Ratio2, Dim2>>;
         return _CT(cast<_CT>(first).value() % cast<_CT>(second).value());
     }
 
+    template<typename UnderlyingType,
+        typename Ratio,
+        typename Dim,
+        typename Lim,
+        typename = internal::arithmetic_enabled<Lim>>
+        constexpr auto operator%(complex_type<UnderlyingType, Ratio, Dim, Lim>&& first, const complex_type<UnderlyingType, Ratio, Dim, Lim>& second)
+        noexcept(internal::is_nothrow_value_v<UnderlyingType> && noexcept(std::declval<UnderlyingType&>() %= std::declval<const UnderlyingType&>()))
+    {
+        using _CT = std::common_type_t<complex_type<UnderlyingType, Ratio, Dim>, complex_type<UnderlyingType, Ratio, Dim>>;
+        first %= second;
+        return _CT(std::move(first).value());
+    }
+
 }
 
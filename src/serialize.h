@@ -0,0 +1,278 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <type_traits>
+
+#include "quantity_vector.h"
+#include "safe_types.h"
+#include "span.h"
+#include "unit_symbol.h"
+
+namespace safe_types
+{
+    // leading block of every encoded sequence of quantities. The fingerprint identifies the unit
+    // (period and the dimension_id and exponent of each dimension tag), the value kind and size its
+    // underlying type; values follow as raw
+    // bytes in the byte order of the writer, which a reader of the other order sees as a wrong magic
+    struct quantity_header
+    {
+        uint32_t magic;
+        uint8_t value_kind;
+        uint8_t value_size;
+        uint16_t reserved;
+        uint64_t fingerprint;
+        uint64_t count;
+    };
+
+    namespace internal
+    {
+        constexpr uint32_t quantity_magic = 0x31515453u; // "STQ1"
+
+        constexpr uint64_t fingerprint_mix(uint64_t hash, uint64_t value) noexcept
+        {
+            for (int byte = 0; byte < 8; ++byte) {
+                hash = (hash ^ ((value >> (8 * byte)) & 0xff)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template<typename Tag, typename = void>
+        struct has_dimension_id : std::false_type
+        {
+        };
+
+        template<typename Tag>
+        struct has_dimension_id<Tag, std::void_t<decltype(dimension_id<Tag>::value)>> : std::true_type
+        {
+        };
+
+        template<typename Power>
+        constexpr uint64_t fingerprint_power() noexcept
+        {
+            static_assert(has_dimension_id<typename Power::tag>::value, "serialized dimension tags need a dimension_id specialization");
+            return fingerprint_mix(fnv1a(dimension_id<typename Power::tag>::value), static_cast<uint64_t>(Power::exponent));
+        }
+
+        // the powers are summed, since their canonical order follows type names and so the compiler
+        template<typename... Powers>
+        constexpr uint64_t fingerprint_powers(uint64_t hash, tuple_dim<Powers...>) noexcept
+        {
+            const uint64_t powers = (uint64_t{ 0 } + ... + fingerprint_power<Powers>());
+            return fingerprint_mix(fingerprint_mix(hash, powers), sizeof...(Powers));
+        }
+
+        // tags enter through their dimension_id, so fingerprints do not depend on the compiler
+        template<typename Period, typename Dimensions>
+        constexpr uint64_t make_fingerprint() noexcept
+        {
+            uint64_t hash = 14695981039346656037ull;
+            hash = fingerprint_mix(hash, static_cast<uint64_t>(Period::num));
+            hash = fingerprint_mix(hash, static_cast<uint64_t>(Period::den));
+            hash = fingerprint_powers(hash, typename Dimensions::num{});
+            return fingerprint_powers(hash, typename Dimensions::den{});
+        }
+
+        template<typename UT>
+        constexpr uint8_t value_kind = std::is_floating_point<UT>::value ? 'f' : std::is_signed<UT>::value ? 'i' : 'u';
+
+        template<typename CT>
+        constexpr quantity_header header_of(size_t count) noexcept
+        {
+            using UT = typename CT::underlying_type;
+            return quantity_header{ quantity_magic, value_kind<UT>, static_cast<uint8_t>(sizeof(UT)), 0,
+                make_fingerprint<typename CT::period::type, typename CT::dimensions>(), static_cast<uint64_t>(count) };
+        }
+
+        template<typename CT>
+        using encode_enabled = std::enable_if_t<_is_complex_type<CT>::value &&
+            std::is_arithmetic<typename CT::underlying_type>::value && !std::is_same<typename CT::underlying_type, bool>::value>;
+
+        // false when a value does not fit CT; the values before it are written
+        template<typename CT>
+        using decode_values_t = bool (*)(const char* bytes, size_t count, CT* values);
+
+        template<typename CT>
+        bool copy_values(const char* bytes, size_t count, CT* values) noexcept
+        {
+            if (count > 0) {
+                std::memcpy(values, bytes, count * sizeof(CT));
+            }
+            return true;
+        }
+
+        // converts count values of type Stored with underlying type StoredUT
+        template<typename CT, typename Stored, typename StoredUT>
+        bool convert_values(const char* bytes, size_t count, CT* values) noexcept
+        {
+            using UT = typename CT::underlying_type;
+            using from = typename Stored::period;
+            using to = typename CT::period;
+            for (size_t i = 0; i < count; ++i) {
+                StoredUT stored;
+                std::memcpy(&stored, bytes + i * sizeof(StoredUT), sizeof(StoredUT));
+                if (!cast_fits<UT, from, to>(stored)) {
+                    return false;
+                }
+                values[i] = CT{ cast_value<UT, from, to>(stored) };
+            }
+            return true;
+        }
+
+        // underlying types a reader converts from: 32 and 64-bit integers, float and double
+        template<typename CT, typename Stored>
+        decode_values_t<CT> convert_kind(const quantity_header& header) noexcept
+        {
+            switch (header.value_kind * 256 + header.value_size) {
+            case 'i' * 256 + 4:
+                return &convert_values<CT, Stored, int32_t>;
+            case 'i' * 256 + 8:
+                return &convert_values<CT, Stored, int64_t>;
+            case 'u' * 256 + 4:
+                return &convert_values<CT, Stored, uint32_t>;
+            case 'u' * 256 + 8:
+                return &convert_values<CT, Stored, uint64_t>;
+            case 'f' * 256 + sizeof(float):
+                return &convert_values<CT, Stored, float>;
+            case 'f' * 256 + sizeof(double):
+                return &convert_values<CT, Stored, double>;
+            default:
+                return nullptr;
+            }
+        }
+
+        template<typename T>
+        struct stored_unit
+        {
+            using type = T;
+        };
+
+        // how to read the values of a block into CT: a memcpy when they are stored as CT, a conversion
+        // when the stored unit is CT or one of the units of its dimension, otherwise nullptr
+        template<typename CT, typename... Units>
+        decode_values_t<CT> find_decoder(const quantity_header& header, unit_list<Units...>) noexcept
+        {
+            const quantity_header own = header_of<CT>(0);
+            if (header.fingerprint == own.fingerprint && header.value_kind == own.value_kind && header.value_size == own.value_size) {
+                return &copy_values<CT>;
+            }
+            decode_values_t<CT> decoder = nullptr;
+            const auto attempt = [&header, &decoder](auto unit) {
+                using Stored = typename decltype(unit)::type;
+                if (decoder == nullptr && header.fingerprint == make_fingerprint<typename Stored::period::type, typename Stored::dimensions>()) {
+                    decoder = convert_kind<CT, Stored>(header);
+                }
+            };
+            attempt(stored_unit<CT>{});
+            (attempt(stored_unit<Units>{}), ...);
+            return decoder;
+        }
+
+        // the header of an encoded block and where its values start; ec is message_size when the
+        // input is shorter than the block and invalid_argument when it does not start with a header
+        inline std::from_chars_result read_header(const char* first, const char* last, quantity_header& header) noexcept
+        {
+            if (static_cast<size_t>(last - first) < sizeof(quantity_header)) {
+                return std::from_chars_result{ first, std::errc::message_size };
+            }
+            std::memcpy(&header, first, sizeof(quantity_header));
+            if (header.magic != quantity_magic) {
+                return std::from_chars_result{ first, std::errc::invalid_argument };
+            }
+            const uint64_t available = static_cast<uint64_t>(last - first) - sizeof(quantity_header);
+            if (header.value_size == 0 || header.count > available / header.value_size) {
+                return std::from_chars_result{ first, std::errc::message_size };
+            }
+            return std::from_chars_result{ first + sizeof(quantity_header), std::errc{} };
+        }
+    }
+
+    // bytes encode writes for count values of CT
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    constexpr size_t encoded_size(size_t count) noexcept
+    {
+        return sizeof(quantity_header) + count * sizeof(typename CT::underlying_type);
+    }
+
+    // writes a header and the values as one memcpy; {last, std::errc::value_too_large} when
+    // the block does not fit
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    std::to_chars_result encode(char* first, char* last, span<const CT> values) noexcept
+    {
+        static_assert(std::is_trivially_copyable<CT>::value && sizeof(CT) == sizeof(typename CT::underlying_type),
+            "encode copies the raw layout of the underlying type");
+        const size_t size = encoded_size<CT>(values.size());
+        if (static_cast<size_t>(last - first) < size) {
+            return std::to_chars_result{ last, std::errc::value_too_large };
+        }
+        const quantity_header header = internal::header_of<CT>(values.size());
+        std::memcpy(first, &header, sizeof(header));
+        if (!values.empty()) {
+            std::memcpy(first + sizeof(header), values.data(), values.size() * sizeof(CT));
+        }
+        return std::to_chars_result{ first + size, std::errc{} };
+    }
+
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    std::to_chars_result encode(char* first, char* last, const quantity_vector<CT>& values) noexcept
+    {
+        return encode(first, last, values.values());
+    }
+
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    std::to_chars_result encode(char* first, char* last, const CT& value) noexcept
+    {
+        return encode(first, last, span<const CT>{ &value, 1 });
+    }
+
+    // reads a block written by encode into values, replacing their contents. Values stored in the unit
+    // and underlying type of CT are copied with one memcpy; values stored in another unit of the
+    // dimension (CT or dimension_units<dimensions>) or with another underlying type are converted with
+    // the rounding of cast. Errors: invalid_argument when the input is not a block or its unit does not
+    // convert to CT, message_size when the input ends inside the block, and result_out_of_range when a
+    // converted value does not fit the underlying type of CT, which leaves values empty
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    std::from_chars_result decode(const char* first, const char* last, quantity_vector<CT>& values)
+    {
+        quantity_header header;
+        const auto read = internal::read_header(first, last, header);
+        if (read.ec != std::errc{}) {
+            return read;
+        }
+        const auto decoder = internal::find_decoder<CT>(header, typename dimension_units<typename CT::dimensions>::type{});
+        if (decoder == nullptr) {
+            return std::from_chars_result{ first, std::errc::invalid_argument };
+        }
+        const size_t count = static_cast<size_t>(header.count);
+        values.resize(count);
+        const char* const end = read.ptr + count * header.value_size;
+        if (!decoder(read.ptr, count, values.values().data())) {
+            values.clear();
+            return std::from_chars_result{ end, std::errc::result_out_of_range };
+        }
+        return std::from_chars_result{ end, std::errc{} };
+    }
+
+    // reads a block of exactly one value; on error value is unchanged
+    template<typename CT, typename = internal::encode_enabled<CT>>
+    std::from_chars_result decode(const char* first, const char* last, CT& value) noexcept
+    {
+        quantity_header header;
+        const auto read = internal::read_header(first, last, header);
+        if (read.ec != std::errc{}) {
+            return read;
+        }
+        const auto decoder = internal::find_decoder<CT>(header, typename dimension_units<typename CT::dimensions>::type{});
+        if (decoder == nullptr || header.count != 1) {
+            return std::from_chars_result{ first, std::errc::invalid_argument };
+        }
+        CT decoded;
+        if (!decoder(read.ptr, 1, &decoded)) {
+            return std::from_chars_result{ read.ptr + header.value_size, std::errc::result_out_of_range };
+        }
+        value = decoded;
+        return std::from_chars_result{ read.ptr + header.value_size, std::errc{} };
+    }
+}
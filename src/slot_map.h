@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "safe_types.h"
+#include "span.h"
+#include "typed_vector.h"
+
+namespace safe_types
+{
+    // key of a slot_map element: the slot and the generation of the slot when the element was
+    // inserted, so a key of an erased element never finds an element inserted into the same slot later
+    template<typename Id>
+    struct generational_id
+    {
+        Id index;
+        uint32_t generation;
+
+        friend bool operator==(const generational_id& first, const generational_id& second) noexcept
+        {
+            return first.index == second.index && first.generation == second.generation;
+        }
+
+        friend bool operator!=(const generational_id& first, const generational_id& second) noexcept
+        {
+            return !(first == second);
+        }
+
+        friend bool operator<(const generational_id& first, const generational_id& second) noexcept
+        {
+            return first.index < second.index || (first.index == second.index && first.generation < second.generation);
+        }
+    };
+
+    // map from stable generational IDs to values with O(1) insert, erase and lookup and no hashing.
+    // Values are packed in one vector (erase moves the last value into the hole), so iteration is
+    // a linear scan; a lookup is an index into the slot table plus a generation compare.
+    template<typename Id, typename T>
+    class slot_map
+    {
+        static_assert(internal::is_index_type<Id>::value, "slot_map is indexed by a singleton over an unsigned integer");
+
+    public:
+        using id_type = Id;
+        using key_type = generational_id<Id>;
+        using value_type = T;
+        using size_type = size_t;
+        using iterator = typename std::vector<T>::iterator;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        size_t size() const noexcept
+        {
+            return m_values.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_values.empty();
+        }
+
+        void reserve(size_t count)
+        {
+            m_slots.reserve(count);
+            m_values.reserve(count);
+            m_owners.reserve(count);
+        }
+
+        key_type insert(const T& value)
+        {
+            return emplace(value);
+        }
+
+        key_type insert(T&& value)
+        {
+            return emplace(std::move(value));
+        }
+
+        template<typename... Args>
+        key_type emplace(Args&&... args)
+        {
+            const Id id = acquire_slot();
+            try {
+                m_values.emplace_back(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                release_slot(id);
+                throw;
+            }
+            m_owners.push_back(id);
+            slot& entry = m_slots[id];
+            entry.position = static_cast<uint32_t>(m_values.size() - 1);
+            return key_type{ id, entry.generation };
+        }
+
+        // false when key is stale
+        bool erase(const key_type& key)
+        {
+            if (!contains(key)) {
+                return false;
+            }
+            const size_t position = m_slots[key.index].position;
+            if (position + 1 != m_values.size()) {
+                m_values[position] = std::move(m_values.back());
+                m_owners[position] = m_owners.back();
+                m_slots[m_owners[position]].position = static_cast<uint32_t>(position);
+            }
+            m_values.pop_back();
+            m_owners.pop_back();
+            release_slot(key.index);
+            return true;
+        }
+
+        // erases every element; all keys become stale
+        void clear() noexcept
+        {
+            for (const Id& id : m_owners) {
+                release_slot(id);
+            }
+            m_values.clear();
+            m_owners.clear();
+        }
+
+        bool contains(const key_type& key) const noexcept
+        {
+            return m_slots.contains(key.index) && m_slots[key.index].generation == key.generation;
+        }
+
+        // nullptr when key is stale
+        T* find(const key_type& key) noexcept
+        {
+            return contains(key) ? &m_values[m_slots[key.index].position] : nullptr;
+        }
+
+        const T* find(const key_type& key) const noexcept
+        {
+            return contains(key) ? &m_values[m_slots[key.index].position] : nullptr;
+        }
+
+        T& operator[](const key_type& key) noexcept
+        {
+            assert(contains(key) && "slot_map key is stale");
+            return m_values[m_slots[key.index].position];
+        }
+
+        const T& operator[](const key_type& key) const noexcept
+        {
+            assert(contains(key) && "slot_map key is stale");
+            return m_values[m_slots[key.index].position];
+        }
+
+        T& at(const key_type& key)
+        {
+            T* value = find(key);
+            if (value == nullptr) {
+                throw std::out_of_range{ "slot_map key is stale" };
+            }
+            return *value;
+        }
+
+        const T& at(const key_type& key) const
+        {
+            const T* value = find(key);
+            if (value == nullptr) {
+                throw std::out_of_range{ "slot_map key is stale" };
+            }
+            return *value;
+        }
+
+        // key of the value at position in iteration order
+        key_type key_at(size_t position) const noexcept
+        {
+            const Id id = m_owners[position];
+            return key_type{ id, m_slots[id].generation };
+        }
+
+        iterator begin() noexcept
+        {
+            return m_values.begin();
+        }
+
+        iterator end() noexcept
+        {
+            return m_values.end();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_values.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_values.end();
+        }
+
+        span<T> values() noexcept
+        {
+            return span<T>{ m_values.data(), m_values.size() };
+        }
+
+        span<const T> values() const noexcept
+        {
+            return span<const T>{ m_values.data(), m_values.size() };
+        }
+
+    private:
+        // generation is odd while the slot holds a value; position is then the index of the value,
+        // otherwise the next free slot
+        struct slot
+        {
+            uint32_t generation;
+            uint32_t position;
+        };
+
+        static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+        Id acquire_slot()
+        {
+            if (m_free == no_slot) {
+                using underlying = typename Id::underlying_type;
+                if (m_slots.size() > static_cast<size_t>(std::numeric_limits<underlying>::max()) || m_slots.size() >= no_slot) {
+                    throw std::length_error{ "slot_map has no free IDs" };
+                }
+                m_slots.push_back(slot{ 0, no_slot });
+                m_free = static_cast<uint32_t>(m_slots.size() - 1);
+            }
+            const Id id = internal::id_of<Id>(m_free);
+            slot& entry = m_slots[id];
+            m_free = entry.position;
+            ++entry.generation;
+            return id;
+        }
+
+        // a slot whose generation wraps around is retired, so no key can ever match it again
+        void release_slot(const Id& id) noexcept
+        {
+            slot& entry = m_slots[id];
+            if (++entry.generation != 0) {
+                entry.position = m_free;
+                m_free = static_cast<uint32_t>(internal::index_of(id));
+            }
+        }
+
+        typed_vector<Id, slot> m_slots;
+        std::vector<T> m_values;
+        // slot of each value
+        std::vector<Id> m_owners;
+        uint32_t m_free = no_slot;
+    };
+}
+
+namespace std
+{
+    template<typename Id>
+    struct hash<safe_types::generational_id<Id>>
+    {
+        size_t operator()(const safe_types::generational_id<Id>& key) const noexcept
+        {
+            return static_cast<size_t>(key.index.value()) * 0x9e3779b97f4a7c15ull ^ key.generation;
+        }
+    };
+}
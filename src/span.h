@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace safe_types
+{
+    // minimal non-owning view over a contiguous sequence (std::span is C++20)
+    template<typename T>
+    class span
+    {
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = size_t;
+        using pointer = T*;
+        using reference = T&;
+        using iterator = T*;
+
+        constexpr span() noexcept
+            : m_data{ nullptr }
+            , m_size{ 0 }
+        {
+        }
+
+        constexpr span(T* data, size_t size) noexcept
+            : m_data{ data }
+            , m_size{ size }
+        {
+        }
+
+        template<typename Container,
+            typename = std::enable_if_t<std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>>
+        constexpr span(Container& container) noexcept
+            : m_data{ container.data() }
+            , m_size{ container.size() }
+        {
+        }
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U(*)[], T(*)[]>::value>>
+        constexpr span(const span<U>& other) noexcept
+            : m_data{ other.data() }
+            , m_size{ other.size() }
+        {
+        }
+
+        constexpr T* data() const noexcept
+        {
+            return m_data;
+        }
+
+        constexpr size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        constexpr T& operator[](size_t index) const noexcept
+        {
+            return m_data[index];
+        }
+
+        constexpr T* begin() const noexcept
+        {
+            return m_data;
+        }
+
+        constexpr T* end() const noexcept
+        {
+            return m_data + m_size;
+        }
+
+        constexpr span subspan(size_t offset, size_t count) const noexcept
+        {
+            return span{ m_data + offset, count };
+        }
+
+    private:
+        T* m_data;
+        size_t m_size;
+    };
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cassert>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "safe_types.h"
+#include "span.h"
+
+namespace safe_types
+{
+    namespace internal
+    {
+        // a dense index: a complex_type over an unsigned integer without scaling
+        template<typename Id>
+        struct is_index_type : std::integral_constant<bool, _is_complex_type<Id>::value &&
+            std::is_integral<typename Id::underlying_type>::value && std::is_unsigned<typename Id::underlying_type>::value &&
+            std::ratio_equal<typename Id::period, std::ratio<1>>::value>
+        {
+        };
+
+        template<typename Id>
+        constexpr size_t index_of(const Id& id) noexcept
+        {
+            return static_cast<size_t>(id.value());
+        }
+
+        template<typename Id>
+        constexpr Id id_of(size_t index) noexcept
+        {
+            return Id{ static_cast<typename Id::underlying_type>(index) };
+        }
+    }
+
+    // vector indexed only by its ID type, e.g. singleton<uint32_t, NodeIdDim>: a node table cannot
+    // be indexed by an edge ID or a plain integer. Element access checks the bound with an assert
+    // only, like std::vector::operator[]; at() throws std::out_of_range.
+    template<typename Id, typename T>
+    class typed_vector
+    {
+        static_assert(internal::is_index_type<Id>::value, "typed_vector is indexed by a singleton over an unsigned integer");
+
+    public:
+        using id_type = Id;
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = typename std::vector<T>::iterator;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        typed_vector() = default;
+
+        explicit typed_vector(size_t count, const T& value = T{})
+            : m_values(count, value)
+        {
+        }
+
+        typed_vector(std::initializer_list<T> values)
+            : m_values(values)
+        {
+        }
+
+        size_t size() const noexcept
+        {
+            return m_values.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_values.empty();
+        }
+
+        size_t capacity() const noexcept
+        {
+            return m_values.capacity();
+        }
+
+        void reserve(size_t count)
+        {
+            m_values.reserve(count);
+        }
+
+        void resize(size_t count)
+        {
+            m_values.resize(count);
+        }
+
+        void resize(size_t count, const T& value)
+        {
+            m_values.resize(count, value);
+        }
+
+        void clear() noexcept
+        {
+            m_values.clear();
+        }
+
+        // the ID the next appended element gets
+        Id next_id() const noexcept
+        {
+            return internal::id_of<Id>(m_values.size());
+        }
+
+        bool contains(const Id& id) const noexcept
+        {
+            return internal::index_of(id) < m_values.size();
+        }
+
+        // appends value and returns its ID
+        Id push_back(const T& value)
+        {
+            const Id id = next_id();
+            m_values.push_back(value);
+            return id;
+        }
+
+        Id push_back(T&& value)
+        {
+            const Id id = next_id();
+            m_values.push_back(std::move(value));
+            return id;
+        }
+
+        template<typename... Args>
+        Id emplace_back(Args&&... args)
+        {
+            const Id id = next_id();
+            m_values.emplace_back(std::forward<Args>(args)...);
+            return id;
+        }
+
+        void pop_back()
+        {
+            m_values.pop_back();
+        }
+
+        T& operator[](const Id& id) noexcept
+        {
+            assert(contains(id) && "typed_vector index out of range");
+            return m_values[internal::index_of(id)];
+        }
+
+        const T& operator[](const Id& id) const noexcept
+        {
+            assert(contains(id) && "typed_vector index out of range");
+            return m_values[internal::index_of(id)];
+        }
+
+        T& at(const Id& id)
+        {
+            return m_values.at(internal::index_of(id));
+        }
+
+        const T& at(const Id& id) const
+        {
+            return m_values.at(internal::index_of(id));
+        }
+
+        T& front() noexcept
+        {
+            return m_values.front();
+        }
+
+        const T& front() const noexcept
+        {
+            return m_values.front();
+        }
+
+        T& back() noexcept
+        {
+            return m_values.back();
+        }
+
+        const T& back() const noexcept
+        {
+            return m_values.back();
+        }
+
+        iterator begin() noexcept
+        {
+            return m_values.begin();
+        }
+
+        iterator end() noexcept
+        {
+            return m_values.end();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_values.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_values.end();
+        }
+
+        T* data() noexcept
+        {
+            return m_values.data();
+        }
+
+        const T* data() const noexcept
+        {
+            return m_values.data();
+        }
+
+        span<T> values() noexcept
+        {
+            return span<T>{ m_values.data(), m_values.size() };
+        }
+
+        span<const T> values() const noexcept
+        {
+            return span<const T>{ m_values.data(), m_values.size() };
+        }
+
+        friend bool operator==(const typed_vector& first, const typed_vector& second)
+        {
+            return first.m_values == second.m_values;
+        }
+
+        friend bool operator!=(const typed_vector& first, const typed_vector& second)
+        {
+            return !(first == second);
+        }
+
+    private:
+        std::vector<T> m_values;
+    };
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <string_view>
+
+#include "safe_types.h"
+
+namespace safe_types
+{
+    template<typename... CT>
+    struct unit_list
+    {
+    };
+
+    // the units whose symbols from_chars recognizes for a dimension; physical_types.h lists its aliases.
+    // Listed units need their own unit_symbol specialization, since synthesized names are built from them
+    template<typename Dimensions>
+    struct dimension_units
+    {
+        using type = unit_list<>;
+    };
+
+    // stable name of a dimension tag in serialized data (serialize.h), e.g. "distance". Unlike the
+    // name of the tag type it does not depend on the compiler or the namespace of the tag; tags
+    // without a specialization cannot be serialized
+    template<typename Tag>
+    struct dimension_id
+    {
+    };
+
+    namespace internal
+    {
+        // a unit of one dimension a name can be built from: an alias of dimension_units, or its
+        // unit of ratio 1 with an SI prefix
+        struct unit_candidate
+        {
+            intmax_t num;
+            intmax_t den;
+            std::string_view prefix;
+            std::string_view symbol;
+        };
+
+        constexpr unit_candidate si_prefixes[] = {
+            { 1, 1000000000, "n", {} }, { 1, 1000000, "u", {} }, { 1, 1000, "m", {} }, { 1, 100, "c", {} },
+            { 1, 10, "d", {} }, { 1000, 1, "k", {} }, { 1000000, 1, "M", {} }, { 1000000000, 1, "G", {} } };
+
+        constexpr size_t si_prefix_count = sizeof(si_prefixes) / sizeof(si_prefixes[0]);
+
+        template<typename Period, typename Dimensions>
+        struct synthesized_symbol;
+    }
+
+    // text written after a value with this period and dimensions, e.g. "ms". physical_types.h
+    // specializes it for its aliases, and a specialization names any other unit, compound ones
+    // included. Otherwise the name is synthesized at compile time from the aliases of each dimension
+    // and SI prefixes ("km/h", "mm/s^2", "nm"); units that cannot be named this way, like singleton
+    // IDs, have an empty symbol and format as the bare number
+    template<typename Period, typename Dimensions>
+    struct unit_symbol : internal::synthesized_symbol<Period, Dimensions>
+    {
+    };
+
+    template<typename CT>
+    constexpr std::string_view unit_symbol_v = unit_symbol<typename CT::period::type, typename CT::dimensions>::value;
+
+    namespace internal
+    {
+        template<size_t N>
+        struct candidate_set
+        {
+            std::array<unit_candidate, N> units;
+            size_t count;
+        };
+
+        template<typename... Units>
+        constexpr auto make_candidates(unit_list<Units...>) noexcept
+        {
+            constexpr std::array<unit_candidate, sizeof...(Units)> units{ { unit_candidate{ Units::period::num, Units::period::den, {}, unit_symbol_v<Units> }... } };
+            candidate_set<sizeof...(Units) * (1 + si_prefix_count)> result{};
+            for (const auto& unit : units) {
+                if (!unit.symbol.empty()) {
+                    result.units[result.count++] = unit;
+                }
+            }
+            for (const auto& unit : units) {
+                if (!unit.symbol.empty() && unit.num == 1 && unit.den == 1) {
+                    for (const auto& prefix : si_prefixes) {
+                        result.units[result.count++] = unit_candidate{ prefix.num, prefix.den, prefix.prefix, unit.symbol };
+                    }
+                }
+            }
+            return result;
+        }
+
+        // the named units of one dimension tag
+        template<typename Tag>
+        constexpr auto tag_candidates = make_candidates(typename dimension_units<dim_ratio<tuple_dim<dim_power<Tag, 1>>, tuple_dim<>>>::type{});
+
+        struct unit_factor
+        {
+            const unit_candidate* candidates;
+            size_t count;
+            // negative in the denominator
+            int exponent;
+        };
+
+        template<typename Power, int Sign>
+        constexpr unit_factor factor_of() noexcept
+        {
+            constexpr auto& candidates = tag_candidates<typename Power::tag>;
+            return unit_factor{ candidates.units.data(), candidates.count, Sign * Power::exponent };
+        }
+
+        // positive fraction, or num == 0 once it overflowed
+        struct fraction
+        {
+            intmax_t num;
+            intmax_t den;
+        };
+
+        constexpr fraction multiply(fraction value, intmax_t num, intmax_t den) noexcept
+        {
+            if (value.num == 0) {
+                return value;
+            }
+            const intmax_t first = gcd(value.num, den);
+            const intmax_t second = gcd(num, value.den);
+            const intmax_t a = value.num / first;
+            const intmax_t b = num / second;
+            const intmax_t c = value.den / second;
+            const intmax_t d = den / first;
+            constexpr intmax_t max = std::numeric_limits<intmax_t>::max();
+            if (a > max / b || c > max / d) {
+                return fraction{ 0, 1 };
+            }
+            return fraction{ a * b, c * d };
+        }
+
+        template<size_t K>
+        struct unit_choice
+        {
+            bool found;
+            std::array<size_t, K> index;
+        };
+
+        // factors named by another unit than their unit of ratio 1 without prefix; a name needing more
+        // is not synthesized, which bounds the search to a few thousand products for any dimension
+        constexpr size_t max_scaled_factors = 3;
+
+        // the unit of ratio 1 without prefix of the factor, or count when its dimension has none
+        constexpr size_t base_unit(const unit_factor& factor) noexcept
+        {
+            for (size_t i = 0; i < factor.count; ++i) {
+                const unit_candidate& unit = factor.candidates[i];
+                if (unit.num == 1 && unit.den == 1 && unit.prefix.empty()) {
+                    return i;
+                }
+            }
+            return factor.count;
+        }
+
+        constexpr fraction multiply_power(fraction value, const unit_factor& factor, const unit_candidate& unit) noexcept
+        {
+            const int power = factor.exponent < 0 ? -factor.exponent : factor.exponent;
+            for (int p = 0; p < power; ++p) {
+                value = factor.exponent < 0 ? multiply(value, unit.den, unit.num) : multiply(value, unit.num, unit.den);
+            }
+            return value;
+        }
+
+        // chooses units for the factors from position on, scaling at most budget of them; the earlier a
+        // factor, the sooner it is scaled, and aliases come before prefixes
+        template<size_t K>
+        constexpr bool choose_units(const std::array<unit_factor, K>& factors, size_t position, size_t budget,
+            fraction product, fraction target, std::array<size_t, K>& index) noexcept
+        {
+            if (product.num == 0) {
+                return false;
+            }
+            if (position == K) {
+                return product.num == target.num && product.den == target.den;
+            }
+            const unit_factor& factor = factors[position];
+            const size_t base = base_unit(factor);
+            if (budget > 0) {
+                for (size_t i = 0; i < factor.count; ++i) {
+                    if (i != base) {
+                        index[position] = i;
+                        if (choose_units(factors, position + 1, budget - 1, multiply_power(product, factor, factor.candidates[i]), target, index)) {
+                            return true;
+                        }
+                    }
+                }
+            }
+            if (base == factor.count) {
+                return false;
+            }
+            index[position] = base;
+            return choose_units(factors, position + 1, budget, product, target, index);
+        }
+
+        // the candidate for each factor whose product is num/den, scaling as few factors as possible
+        // and the first ones among equals: km^3/(s*g) rather than m^3/(g*ns)
+        template<size_t K>
+        constexpr unit_choice<K> find_units(const std::array<unit_factor, K>& factors, intmax_t num, intmax_t den) noexcept
+        {
+            unit_choice<K> choice{ false, {} };
+            for (size_t budget = 0; budget <= max_scaled_factors && budget <= K; ++budget) {
+                if (choose_units(factors, 0, budget, fraction{ 1, 1 }, fraction{ num, den }, choice.index)) {
+                    choice.found = true;
+                    return choice;
+                }
+            }
+            return choice;
+        }
+
+        constexpr size_t write_text(char* out, size_t at, std::string_view text) noexcept
+        {
+            for (const char c : text) {
+                if (out != nullptr) {
+                    out[at] = c;
+                }
+                ++at;
+            }
+            return at;
+        }
+
+        // "km*h^2"; skips factors whose exponent sign differs from sign
+        template<size_t K>
+        constexpr size_t write_factors(char* out, size_t at, const std::array<unit_factor, K>& factors, const std::array<size_t, K>& index, int sign) noexcept
+        {
+            bool first = true;
+            for (size_t i = 0; i < K; ++i) {
+                const int exponent = factors[i].exponent * sign;
+                if (exponent <= 0) {
+                    continue;
+                }
+                if (!first) {
+                    at = write_text(out, at, "*");
+                }
+                first = false;
+                const unit_candidate& unit = factors[i].candidates[index[i]];
+                at = write_text(out, at, unit.prefix);
+                at = write_text(out, at, unit.symbol);
+                if (exponent > 1) {
+                    char digits[12] = {};
+                    size_t count = 0;
+                    for (int rest = exponent; rest > 0; rest /= 10) {
+                        digits[count++] = static_cast<char>('0' + rest % 10);
+                    }
+                    at = write_text(out, at, "^");
+                    while (count > 0) {
+                        at = write_text(out, at, std::string_view{ &digits[--count], 1 });
+                    }
+                }
+            }
+            return at;
+        }
+
+        // the length of the name; writes it when out is not null
+        template<size_t K>
+        constexpr size_t write_name(char* out, const std::array<unit_factor, K>& factors, const unit_choice<K>& choice) noexcept
+        {
+            if (!choice.found || K == 0) {
+                return 0;
+            }
+            size_t numerators = 0;
+            size_t denominators = 0;
+            for (const auto& factor : factors) {
+                ++(factor.exponent > 0 ? numerators : denominators);
+            }
+            size_t at = numerators == 0 ? write_text(out, 0, "1") : write_factors(out, 0, factors, choice.index, 1);
+            if (denominators > 0) {
+                at = write_text(out, at, denominators > 1 ? "/(" : "/");
+                at = write_factors(out, at, factors, choice.index, -1);
+                at = write_text(out, at, denominators > 1 ? ")" : "");
+            }
+            return at;
+        }
+
+        template<size_t Length>
+        struct static_text
+        {
+            char data[Length + 1];
+        };
+
+        template<size_t Length, size_t K>
+        constexpr static_text<Length> make_text(const std::array<unit_factor, K>& factors, const unit_choice<K>& choice) noexcept
+        {
+            static_text<Length> text{};
+            write_name(text.data, factors, choice);
+            return text;
+        }
+
+        template<intmax_t Num, intmax_t Den, typename... Nums, typename... Dens>
+        struct synthesized_symbol<std::ratio<Num, Den>, dim_ratio<tuple_dim<Nums...>, tuple_dim<Dens...>>>
+        {
+            static constexpr std::array<unit_factor, sizeof...(Nums) + sizeof...(Dens)> factors{ { factor_of<Nums, 1>()..., factor_of<Dens, -1>()... } };
+            static constexpr auto choice = find_units(factors, Num, Den);
+            static constexpr size_t length = write_name(nullptr, factors, choice);
+            static constexpr static_text<length> text = make_text<length>(factors, choice);
+            static constexpr std::string_view value{ text.data, length };
+        };
+    }
+}